@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Node memory for one order book.
+ *
+ * Once reserve()d, carves fixed-size blocks out of large mapped regions and
+ * recycles them through per-size free lists, so resting orders and price
+ * levels never go through the general-purpose heap on the matching path.
+ * Regions are pre-faulted when mapped and can additionally be backed by huge
+ * pages and locked into RAM. An arena that was never reserved (the
+ * power-saving profile, or a failed reserve) maps nothing and simply
+ * forwards to operator new and delete.
+ *
+ * Not thread-safe: it belongs to the book, which only the engine thread
+ * touches.
+ */
+class BookArena {
+public:
+    BookArena() = default;
+    ~BookArena();
+
+    // Non-copyable
+    BookArena(const BookArena&) = delete;
+    BookArena& operator=(const BookArena&) = delete;
+
+    /**
+     * @brief Maps, pre-faults and optionally locks `bytes` of node memory up front.
+     *
+     * Call before the first allocation; until then the arena uses the default
+     * allocator. Regions mapped later to grow the arena use the same huge page
+     * and locking settings.
+     *
+     * @param hugepages Try explicit huge pages, then transparent huge pages
+     * @param lock mlock() the regions so they are never paged out
+     * @return False if the memory could not be mapped
+     */
+    bool reserve(std::size_t bytes, bool hugepages, bool lock);
+
+    void* allocate(std::size_t bytes, std::size_t alignment);
+    void deallocate(void* block, std::size_t bytes, std::size_t alignment) noexcept;
+
+    /// True once reserve() has succeeded and nodes come from mapped regions
+    bool reserved() const { return reserved_; }
+
+    /// Total bytes mapped so far
+    std::size_t mapped_bytes() const { return mapped_bytes_; }
+
+    /// True if any region is backed by explicit huge pages
+    bool huge_pages() const { return huge_backed_; }
+
+    /// True if every region so far has been locked into RAM
+    bool locked() const { return lock_ && !lock_failed_; }
+
+private:
+    static constexpr std::size_t kGranule = 16;
+    static constexpr std::size_t kMaxBlock = 1024;           // Larger requests go to operator new
+    static constexpr std::size_t kRegionBytes = 2u << 20;    // One 2 MiB huge page
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Region {
+        void* base;
+        std::size_t bytes;
+    };
+
+    /// Maps a new region of at least `bytes` and makes it the current bump region
+    bool map_region(std::size_t bytes);
+
+    std::array<FreeBlock*, kMaxBlock / kGranule> free_lists_{};
+    char* cursor_ = nullptr;
+    char* limit_ = nullptr;
+    std::vector<Region> regions_;
+    std::size_t mapped_bytes_ = 0;
+
+    bool reserved_ = false;
+    bool hugepages_ = false;
+    bool lock_ = false;
+    bool huge_backed_ = false;
+    bool lock_failed_ = false;
+};
+
+/**
+ * @brief Standard allocator drawing from a BookArena, for the book's node containers.
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(BookArena& arena) noexcept : arena_(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* block, std::size_t n) noexcept {
+        arena_->deallocate(block, n * sizeof(T), alignof(T));
+    }
+
+    BookArena* arena() const noexcept { return arena_; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+    BookArena* arena_;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "order_book.hpp"
+#include "book_view.hpp"
 #include <iostream>
 
 /**
@@ -28,9 +29,7 @@ public:
 
         // Print buy side (descending order)
         std::cout << "\n[BUY ORDERS]\n";
-        for (auto it = book.buy_orders().rbegin(); it != book.buy_orders().rend(); ++it) {
-            const auto& price = it->first;
-            const auto& orders = it->second;
+        for (const auto& [price, orders] : book.buy_orders()) {
             std::cout << "Price " << price << ": ";
             for (const auto& order : orders) {
                 std::cout << order.quantity() << " ";
@@ -40,4 +39,31 @@ public:
 
         std::cout << "----------------------\n";
     }
+
+    /**
+     * @brief Prints a published depth snapshot (aggregated per price) to stdout.
+     *
+     * @param book Snapshot read from the engine's BookView
+     */
+    static void print(const BookSnapshot& book) {
+        std::cout << "----- TOP OF BOOK (seq " << book.sequence
+                  << (book.in_auction ? ", auction" : "") << ") -----\n";
+
+        std::cout << "[SELL LEVELS]\n";
+        for (std::uint32_t i = book.ask_levels; i-- > 0;) {
+            const DepthLevel& level = book.asks[i];
+            std::cout << "Price " << level.price << ": " << level.quantity
+                      << " (" << level.orders << " orders)\n";
+        }
+
+        std::cout << "\n[BUY LEVELS]\n";
+        for (std::uint32_t i = 0; i < book.bid_levels; ++i) {
+            const DepthLevel& level = book.bids[i];
+            std::cout << "Price " << level.price << ": " << level.quantity
+                      << " (" << level.orders << " orders)\n";
+        }
+
+        std::cout << "Last trade: " << book.last_trade_price << "\n";
+        std::cout << "----------------------\n";
+    }
 };
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "order.hpp"
+#include "order_book.hpp"
+#include "seqlock.hpp"
+
+/**
+ * @brief Aggregate resting interest at one price.
+ */
+struct DepthLevel {
+    double price;
+    long long quantity;     ///< Sum of resting quantity
+    std::uint32_t orders;   ///< Number of resting orders
+};
+
+/**
+ * @brief Top of book and the best kDepth levels per side, as of one engine input.
+ */
+struct BookSnapshot {
+    static constexpr std::size_t kDepth = 10;
+
+    std::uint64_t sequence;      ///< Last engine input reflected (0 before the first)
+    double last_trade_price;     ///< 0 until the first trade
+    std::uint32_t bid_levels;    ///< Valid entries in `bids`
+    std::uint32_t ask_levels;    ///< Valid entries in `asks`
+    bool in_auction;
+    DepthLevel bids[kDepth];     ///< Highest price first
+    DepthLevel asks[kDepth];     ///< Lowest price first
+};
+
+/**
+ * @brief Lifecycle state of an order as seen by the engine.
+ */
+enum class OrderStatus : std::uint8_t { UNKNOWN, NEW, PARTIALLY_FILLED, FILLED, EXPIRED, CANCELED };
+
+inline std::string to_string(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::NEW: return "NEW";
+        case OrderStatus::PARTIALLY_FILLED: return "PARTIALLY_FILLED";
+        case OrderStatus::FILLED: return "FILLED";
+        case OrderStatus::EXPIRED: return "EXPIRED";
+        case OrderStatus::CANCELED: return "CANCELED";
+        default: return "UNKNOWN";
+    }
+}
+
+/**
+ * @brief Published state of one order.
+ */
+struct OrderStatusRecord {
+    char order_id[24];            ///< NUL-terminated, truncated to 23 characters
+    double price;
+    std::int32_t quantity;        ///< Original quantity
+    std::int32_t filled_quantity;
+    OrderStatus status;
+    OrderSide side;
+
+    /// Quantity still working in the book
+    int leaves_quantity() const {
+        const bool working = status == OrderStatus::NEW || status == OrderStatus::PARTIALLY_FILLED;
+        return working ? quantity - filled_quantity : 0;
+    }
+};
+
+/**
+ * @brief Read-side view of the engine's state for any number of reader threads.
+ *
+ * The engine thread publishes into seqlocks after applying each input, so it
+ * never takes a lock or waits on a reader; readers (admin console, gateway
+ * queries, risk or monitoring threads) copy a consistent snapshot and retry
+ * only if they overlapped a write.
+ *
+ * Order status lives in a fixed open-addressed table of kStatusSlots entries,
+ * probed linearly from a hash of the order ID for at most kMaxProbe slots.
+ * Closed orders (filled, expired, canceled) stay in place as tombstones: they
+ * keep probe chains intact and still answer lookups until a new order reuses
+ * the slot. Working orders are never displaced; a new order whose probe
+ * window holds only working orders goes untracked.
+ */
+class BookView {
+public:
+    static constexpr std::size_t kStatusSlots = 1 << 16;
+    static constexpr std::size_t kMaxProbe = 64;
+
+    BookView();
+
+    // Non-copyable
+    BookView(const BookView&) = delete;
+    BookView& operator=(const BookView&) = delete;
+
+    /// Engine thread only. Publishes top-of-book and depth
+    void publish_book(const OrderBook& book, std::uint64_t sequence, double last_trade_price, bool in_auction);
+
+    /// Engine thread only. Records a newly received order as NEW
+    void order_accepted(const Order& order);
+
+    /// Engine thread only. Adds a fill to an order's cumulative filled quantity
+    void order_filled(const std::string& order_id, int quantity);
+
+    /// Engine thread only. Marks an order as done (expired or canceled) with no leaves
+    void order_closed(const std::string& order_id, OrderStatus status);
+
+    /// Engine thread only. Forgets every order's status (a standby restoring a snapshot)
+    void reset();
+
+    /// Any thread. Latest published book
+    BookSnapshot snapshot() const { return book_.load(); }
+
+    /**
+     * @brief Any thread. Looks up the latest status of an order.
+     *
+     * @return False if the order is unknown, untracked, or its slot has been reused
+     */
+    bool order_status(const std::string& order_id, OrderStatusRecord& out) const;
+
+private:
+    using StatusSlot = Seqlock<OrderStatusRecord>;
+
+    /// First slot of an order ID's probe window
+    static std::size_t home_slot(const std::string& order_id);
+
+    /// Slot holding `order_id`, or nullptr if untracked (engine thread only)
+    StatusSlot* find_slot(const std::string& order_id) const;
+
+    /// Fixed-width copy of an order ID, as stored in a record
+    static void copy_id(char (&dest)[24], const std::string& order_id);
+
+    /// True if a new order may take the slot: never used, or its order has closed
+    static bool reusable(const OrderStatusRecord& record);
+
+    Seqlock<BookSnapshot> book_;
+    std::unique_ptr<StatusSlot[]> statuses_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+
+class ClientOrderList;
+
+/**
+ * @brief Intrusive hook linking a resting order into its client's order list.
+ *
+ * Embed by inheritance. A node unlinks itself when destroyed, so an order
+ * that leaves the book for any reason (fill, expiry, cancel) drops out of
+ * its client's list without the list being told.
+ */
+class ClientOrderNode {
+public:
+    ClientOrderNode() = default;
+    ~ClientOrderNode() { unlink(); }
+
+    ClientOrderNode(const ClientOrderNode&) = delete;
+    ClientOrderNode& operator=(const ClientOrderNode&) = delete;
+
+    /// True while linked into a client's list
+    bool linked() const { return list_ != nullptr; }
+
+    /// Removes the node from its list, if any. O(1)
+    inline void unlink();
+
+private:
+    friend class ClientOrderList;
+
+    ClientOrderNode* prev_ = this;
+    ClientOrderNode* next_ = this;
+    ClientOrderList* list_ = nullptr;
+};
+
+/**
+ * @brief Circular doubly-linked list of one client's resting orders.
+ *
+ * Not movable: nodes point back at the list, so it must live somewhere with
+ * a stable address (e.g. a node-based map).
+ */
+class ClientOrderList {
+public:
+    ClientOrderList() = default;
+
+    ~ClientOrderList() {
+        while (head_.next_ != &head_) {
+            head_.next_->unlink();
+        }
+    }
+
+    ClientOrderList(const ClientOrderList&) = delete;
+    ClientOrderList& operator=(const ClientOrderList&) = delete;
+
+    /// Appends a node (moving it from any list it is already in)
+    void push_back(ClientOrderNode& node) {
+        node.unlink();
+        node.prev_ = head_.prev_;
+        node.next_ = &head_;
+        head_.prev_->next_ = &node;
+        head_.prev_ = &node;
+        node.list_ = this;
+        ++size_;
+    }
+
+    /**
+     * @brief Calls `visit(ClientOrderNode&)` on every node, oldest first.
+     *
+     * The visitor may unlink or destroy the node it is given.
+     */
+    template<typename Visit>
+    void for_each(Visit&& visit) {
+        ClientOrderNode* node = head_.next_;
+        while (node != &head_) {
+            ClientOrderNode* next = node->next_;
+            visit(*node);
+            node = next;
+        }
+    }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+private:
+    friend class ClientOrderNode;
+
+    ClientOrderNode head_;
+    std::size_t size_ = 0;
+};
+
+inline void ClientOrderNode::unlink() {
+    if (!list_) return;
+    prev_->next_ = next_;
+    next_->prev_ = prev_;
+    prev_ = next_ = this;
+    --list_->size_;
+    list_ = nullptr;
+}
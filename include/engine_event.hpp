@@ -0,0 +1,84 @@
+#pragma once
+
+#include "order.hpp"
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief Kinds of input consumed by the matching engine, in arrival order.
+ */
+enum class EngineEventType {
+    NEW_ORDER,        ///< Match (or, during an auction, rest) the carried order
+    AUCTION_START,    ///< Suspend continuous matching; orders accumulate in the book
+    AUCTION_UNCROSS,  ///< Execute at the equilibrium price and resume continuous matching
+    EXPIRE_TIMERS,    ///< One batch of order expiries (replicated from the primary)
+    CANCEL_CLIENT,    ///< Cancel a session's resting orders (mass cancel or disconnect)
+    SNAPSHOT,         ///< Standby only: replace the book and clock with the primary's, as of `sequence`
+    RESTORE_ORDER,    ///< Standby only: one resting order of the preceding SNAPSHOT
+    TAKE_SNAPSHOT,    ///< Snapshot builder only: stream the book to the publisher as of the last input
+    PROMOTE,          ///< Standby only: stop following the primary and start trading
+    SHUTDOWN          ///< Stop the engine loop
+};
+
+/**
+ * @brief Engine state carried by a SNAPSHOT, ahead of its RESTORE_ORDER events.
+ */
+struct SnapshotState {
+    std::uint64_t day_close = 0;      ///< Tick at which DAY orders expire
+    std::uint64_t timer_tick = 0;     ///< Position of the expiry wheel (may trail the clock)
+    std::uint64_t order_number = 0;   ///< Highest "ORD<n>" number the primary has handed out
+    double last_trade_price = 0.0;
+    bool in_auction = false;
+    std::uint32_t orders = 0;         ///< Number of RESTORE_ORDER events that follow
+};
+
+/**
+ * @brief Where a restored order's expiry sits in the timer wheel.
+ */
+struct TimerPosition {
+    std::uint32_t rank = 0;   ///< Place in the order the wheel visits its timers
+    std::uint8_t level = 0;
+    std::uint8_t slot = 0;
+};
+
+/**
+ * @brief A single sequenced input to the matching engine.
+ *
+ * Orders and control actions travel through the same queue so that the
+ * engine observes them in one well-defined order. The engine stamps each
+ * applied event with a sequence number and its clock tick; replaying the
+ * stamped stream reproduces the same book on a standby.
+ */
+struct EngineEvent {
+    EngineEventType type = EngineEventType::SHUTDOWN;
+    Order order;                  ///< Valid for NEW_ORDER
+    double reference_price = 0.0; ///< AUCTION_UNCROSS tie-break price (0 = last trade price)
+    SessionId session = kNoSession; ///< CANCEL_CLIENT: session whose orders are canceled
+    CancelFilter cancel_filter;   ///< CANCEL_CLIENT: which of them
+    SnapshotState snapshot;       ///< SNAPSHOT
+    TimerPosition timer;          ///< RESTORE_ORDER, for DAY/GTD orders
+    std::uint64_t sequence = 0;   ///< Position in the engine's input stream (set by the engine)
+    std::uint64_t tick = 0;       ///< Engine clock (ms since epoch) when applied (set by the engine)
+
+    static EngineEvent new_order(Order order) {
+        EngineEvent event;
+        event.type = EngineEventType::NEW_ORDER;
+        event.order = std::move(order);
+        return event;
+    }
+
+    static EngineEvent cancel_client(SessionId session, CancelFilter filter = {}) {
+        EngineEvent event;
+        event.type = EngineEventType::CANCEL_CLIENT;
+        event.session = session;
+        event.cancel_filter = filter;
+        return event;
+    }
+
+    static EngineEvent control(EngineEventType type, double reference_price = 0.0) {
+        EngineEvent event;
+        event.type = type;
+        event.reference_price = reference_price;
+        return event;
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+#include <utility>
+#include "order.hpp"
+#include "trade.hpp"
+
+/**
+ * @brief Kinds of execution report sent from the matching engine to the gateway.
+ */
+enum class ReportType {
+    TRADE,     ///< A fill between two orders
+    CANCELED,  ///< A resting order was canceled (mass cancel, disconnect or failover)
+    EXPIRED    ///< A DAY or GTD order reached its expiry
+};
+
+inline std::string to_string(ReportType type) {
+    switch (type) {
+        case ReportType::CANCELED: return "CANCELED";
+        case ReportType::EXPIRED: return "EXPIRED";
+        default: return "TRADE";
+    }
+}
+
+/**
+ * @brief One report from the matching engine, in the order the engine produced it.
+ *
+ * Fills and order closures travel through the same queue so that a client
+ * always sees a partial fill before the cancel or expiry of its remainder.
+ */
+struct ExecutionReport {
+    ReportType type = ReportType::TRADE;
+    Trade trade;                      ///< Valid for TRADE
+    std::string order_id;             ///< CANCELED/EXPIRED: the order that left the book
+    std::string client_id;
+    SessionId session = kNoSession;   ///< CANCELED/EXPIRED: session that entered the order
+    OrderSide side = OrderSide::BUY;
+    double price = 0.0;
+    int leaves_quantity = 0;          ///< Quantity that was still resting
+
+    static ExecutionReport fill(Trade trade) {
+        ExecutionReport report;
+        report.trade = std::move(trade);
+        return report;
+    }
+
+    static ExecutionReport closed(ReportType type, const Order& order) {
+        ExecutionReport report;
+        report.type = type;
+        report.order_id = order.id();
+        report.client_id = order.client_id();
+        report.session = order.session_id();
+        report.side = order.side();
+        report.price = order.price();
+        report.leaves_quantity = order.quantity();
+        return report;
+    }
+
+    /// True if the report concerns an order entered on `session_id`
+    bool addressed_to(SessionId session_id) const {
+        if (type == ReportType::TRADE) {
+            return trade.buy_session == session_id || trade.sell_session == session_id;
+        }
+        return session == session_id;
+    }
+
+    /**
+     * @brief Converts the report to a human-readable string.
+     */
+    std::string to_string() const {
+        if (type == ReportType::TRADE) return trade.to_string();
+
+        std::ostringstream oss;
+        oss << ::to_string(type) << ": " << order_id << " " << ::to_string(side) << " "
+            << leaves_quantity << " @ " << price << " [CLIENT: " << client_id << "]";
+        return oss.str();
+    }
+};
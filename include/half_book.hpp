@@ -0,0 +1,185 @@
+#pragma once
+
+#include <map>
+#include <list>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include "order.hpp"
+#include "trade.hpp"
+#include "timer_wheel.hpp"
+#include "client_order_list.hpp"
+#include "book_arena.hpp"
+
+struct RestingOrder;
+
+/// Time-priority queue of one price level; nodes come from the book's arena
+using OrderList = std::list<RestingOrder, ArenaAllocator<RestingOrder>>;
+
+/**
+ * @brief All resting orders at one price, in time priority.
+ *
+ * Keeps the aggregate resting quantity alongside the queue so depth can be
+ * read without walking individual orders.
+ */
+struct PriceLevel {
+    explicit PriceLevel(BookArena& arena);
+
+    OrderList orders;
+    long long quantity = 0;   ///< Sum of resting quantity at this price
+
+    auto begin() const { return orders.begin(); }
+    auto end() const { return orders.end(); }
+};
+
+/**
+ * @brief Iterator to a price level in either side's map.
+ *
+ * The sides' maps differ only in their comparator, which no mainstream
+ * standard library makes part of the iterator type; HalfBook asserts this.
+ */
+using LevelIterator = std::map<double, PriceLevel, std::less<double>,
+                               ArenaAllocator<std::pair<const double, PriceLevel>>>::iterator;
+
+/**
+ * @brief An order resting in the book.
+ *
+ * Lives in a node-based list so its address is stable for as long as it
+ * rests; that lets an expiry timer, its client's order list (and anything
+ * else holding a reference) find and remove it in O(1).
+ */
+struct RestingOrder : public Order, public TimerNode, public ClientOrderNode {
+    explicit RestingOrder(Order&& order) : Order(std::move(order)) {}
+
+    OrderList::iterator position;  ///< This order's node in its price level
+    LevelIterator level;           ///< The price level it rests in
+};
+
+inline PriceLevel::PriceLevel(BookArena& arena) : orders(ArenaAllocator<RestingOrder>(arena)) {}
+
+/**
+ * @brief One side of the order book, specialised at compile time.
+ *
+ * Levels are ordered best-first for the side (descending for BUY, ascending
+ * for SELL), so every loop walks forward from begin() and the only
+ * side-dependent logic is resolved with `if constexpr`. Level and order
+ * nodes are allocated from the owning book's arena.
+ */
+template<OrderSide Side>
+class HalfBook {
+public:
+    using Compare = std::conditional_t<Side == OrderSide::BUY, std::greater<double>, std::less<double>>;
+    using Levels = std::map<double, PriceLevel, Compare,
+                            ArenaAllocator<std::pair<const double, PriceLevel>>>;
+    static_assert(std::is_same<typename Levels::iterator, LevelIterator>::value,
+                  "RestingOrder::level must hold an iterator into either side");
+
+    explicit HalfBook(BookArena& arena)
+        : arena_(arena), levels_(Compare{}, typename Levels::allocator_type(arena)) {}
+
+    /**
+     * @brief True if a resting level on this side is marketable against an aggressor's limit.
+     */
+    static bool crosses(double level_price, double limit) {
+        if constexpr (Side == OrderSide::BUY) {
+            return level_price >= limit;
+        } else {
+            return level_price <= limit;
+        }
+    }
+
+    /**
+     * @brief Rests an order at the back of its price level.
+     *
+     * @return The resting order; valid until it is filled or removed
+     */
+    RestingOrder& add(Order order) {
+        const auto level = levels_.try_emplace(order.price(), arena_).first;
+        level->second.quantity += order.quantity();
+        RestingOrder& resting = level->second.orders.emplace_back(std::move(order));
+        resting.position = std::prev(level->second.orders.end());
+        resting.level = level;
+        return resting;
+    }
+
+    /**
+     * @brief Removes a resting order from anywhere in this side. O(1)
+     */
+    void remove(RestingOrder& order) {
+        const auto level = order.level;
+        level->second.quantity -= order.quantity();
+        level->second.orders.erase(order.position);
+        if (level->second.orders.empty()) {
+            levels_.erase(level);
+        }
+    }
+
+    /**
+     * @brief Matches an aggressor from the opposite side against this side.
+     *
+     * Appends one trade per fill and leaves the unfilled quantity on `incoming`.
+     */
+    void sweep(Order& incoming, std::vector<Trade>& trades) {
+        int quantity_remaining = incoming.quantity();
+
+        while (quantity_remaining > 0 && !levels_.empty() &&
+               crosses(levels_.begin()->first, incoming.price())) {
+            RestingOrder& resting = front();
+            const int traded_quantity = std::min(quantity_remaining, resting.quantity());
+
+            if constexpr (Side == OrderSide::SELL) {
+                trades.emplace_back(incoming.client_id(), resting.client_id(),
+                                    resting.price(), traded_quantity,
+                                    incoming.session_id(), resting.session_id(),
+                                    incoming.id(), resting.id());
+            } else {
+                trades.emplace_back(resting.client_id(), incoming.client_id(),
+                                    resting.price(), traded_quantity,
+                                    resting.session_id(), incoming.session_id(),
+                                    resting.id(), incoming.id());
+            }
+
+            quantity_remaining -= traded_quantity;
+            consume_front(traded_quantity);
+        }
+
+        incoming.set_quantity(quantity_remaining);
+    }
+
+    /// Oldest order at the best price. Precondition: !empty()
+    RestingOrder& front() { return levels_.begin()->second.orders.front(); }
+
+    /// Best price on this side. Precondition: !empty()
+    double best_price() const { return levels_.begin()->first; }
+
+    /**
+     * @brief Fills `quantity` of the front order, removing it (and its level) once exhausted.
+     */
+    void consume_front(int quantity) {
+        auto level = levels_.begin();
+        RestingOrder& resting = level->second.orders.front();
+        resting.set_quantity(resting.quantity() - quantity);
+        level->second.quantity -= quantity;
+
+        if (resting.quantity() == 0) {
+            level->second.orders.pop_front();
+            if (level->second.orders.empty()) {
+                levels_.erase(level);
+            }
+        }
+    }
+
+    /// Removes every resting order on this side
+    void clear() { levels_.clear(); }
+
+    bool empty() const { return levels_.empty(); }
+
+    /// Read-only access to the price levels, best first
+    const Levels& levels() const { return levels_; }
+
+private:
+    BookArena& arena_;
+    Levels levels_;
+};
@@ -2,23 +2,53 @@
 
 #include "order.hpp"
 #include "trade.hpp"
+#include "execution_report.hpp"
 #include "order_book.hpp"
+#include "engine_event.hpp"
 #include "thread_safe_queue.hpp"
+#include "timer_wheel.hpp"
+#include "replication.hpp"
+#include "book_view.hpp"
 #include <atomic>
+#include <chrono>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Core matching engine.
- *        Pulls orders from an input queue, matches them,
- *        pushes resulting trades to an output queue,
- *        and manages the internal order book.
+ *        Pulls events from an input queue, matches orders,
+ *        pushes execution reports (trades, cancels, expiries)
+ *        to an output queue, and manages the internal order book.
+ *
+ * Runs in one of two phases: continuous matching (default), or a call
+ * auction in which orders rest without matching until an uncross event.
+ *
+ * DAY and GTD orders are expired from the engine thread via a timer wheel
+ * (1 ms ticks), in bounded batches interleaved with incoming events.
+ *
+ * Every applied input (including each expiry batch) is stamped with a
+ * sequence number and the engine tick. A primary can stream that sequence
+ * to standbys; a standby engine in replica mode takes its clock from the
+ * stream rather than the wall clock, so it reproduces the primary's book
+ * exactly, and publishes no trades until it is promoted. On promotion it
+ * cancels the orders of every session it inherited, since those clients
+ * were connected to the old primary. The replication publisher runs one more
+ * replica of its own, which streams a snapshot of its book and clocks when
+ * asked; a standby that has fallen too far behind restores that instead, and
+ * the primary's engine thread never stops to take one.
+ *
+ * After each applied input the engine publishes top-of-book, depth and
+ * order status to a BookView that other threads read without locking.
+ *
+ * By default an idle engine sleeps on its queue; with busy polling it
+ * spins instead, trading a core for wake-up latency.
  */
 class MatchingEngine {
 public:
-    using OrderQueue = ThreadSafeQueue<Order>;
-    using TradeQueue = ThreadSafeQueue<Trade>;
+    using EventQueue = ThreadSafeQueue<EngineEvent>;
+    using ReportQueue = ThreadSafeQueue<ExecutionReport>;
 
-    MatchingEngine(OrderQueue& in, TradeQueue& out)
-        : in_queue_(in), trade_queue_(out) {}
+    MatchingEngine(EventQueue& in, ReportQueue& out);
 
     /// Starts the matching loop (blocking call)
     void run();
@@ -26,12 +56,98 @@ public:
     /// Signals the engine to stop
     void stop();
 
-    /// Access the internal order book (for diagnostics/logging)
+    /// Access the internal order book (for diagnostics/logging once the engine has stopped)
     OrderBook& book();
 
+    /// Lock-free view of the book and order status, safe to read from any thread while running
+    const BookView& view() const { return view_; }
+
+    /// Sets when DAY orders expire (default: end of the current UTC day). Call before run()
+    void set_day_close(std::chrono::system_clock::time_point close);
+
+    /// Streams every applied input to standbys; a replica streams snapshots to it instead. Call before run()
+    void set_replication(ReplicationPublisher* publisher);
+
+    /// Runs as a hot standby fed by a ReplicaReceiver until a PROMOTE event. Call before run()
+    void set_replica(bool replica);
+
+    /// Spins on the input queue instead of blocking when idle. Call before run()
+    void set_busy_poll(bool busy_poll);
+
+    /// Sequence number of the last input applied to the book
+    std::uint64_t applied_sequence() const { return applied_sequence_.load(std::memory_order_acquire); }
+
 private:
+    /// Milliseconds since the epoch: the timer wheel's tick
+    static std::uint64_t to_tick(std::chrono::system_clock::time_point time);
+
+    /// Primary loop body: own clock, own expiry batches, sequences and replicates inputs
+    void run_primary_step();
+
+    /// Standby loop body: applies one replicated input at the primary's tick
+    void run_replica_step();
+
+    /// Primary: sequences, replicates and applies one input, then publishes the view
+    void submit(EngineEvent& event);
+
+    /// Snapshot builder: streams the book, clocks and timer layout to the publisher as of the last input
+    void publish_snapshot();
+
+    /// Standby: replaces the book with a snapshot, one SNAPSHOT or RESTORE_ORDER event at a time
+    void restore(EngineEvent& event);
+
+    /// Applies one input to the book
+    void apply(EngineEvent& event);
+
+    /// Sets the engine clock and rolls the DAY close past it
+    void advance_clock(std::uint64_t tick);
+
+    /// Expires one bounded batch of due orders; returns the number expired
+    std::size_t expire_orders();
+
+    /// Arms the expiry timer of a DAY/GTD order that has just come to rest
+    void schedule_expiry(RestingOrder& order);
+
+    /// Continuous matching, or resting the order while an auction is open
+    void process_order(Order& order);
+
+    /// Cancels a session's resting orders (mass cancel request or disconnect)
+    void cancel_client_orders(SessionId session, const CancelFilter& filter);
+
+    /// On promotion: cancels every order left by the old primary's sessions, as sequenced inputs
+    void cancel_inherited_sessions();
+
+    /// Executes the auction at its equilibrium price and resumes continuous matching
+    void uncross_auction(double reference_price);
+
+    /// Pushes trades to the output queue and records the last traded price
+    void publish(std::vector<Trade>& trades);
+
+    /// Reports an order leaving the book without trading (primary only)
+    void report_closed(ReportType type, const Order& order);
+
+    /// Publishes the book as of the last applied input to the view
+    void publish_view();
+
     std::atomic<bool> running_{true};
-    OrderQueue& in_queue_;
-    TradeQueue& trade_queue_;
+    EventQueue& in_queue_;
+    ReportQueue& report_queue_;
+    TimerWheel expiry_wheel_;  // Declared before book_ so it outlives the orders it references
     OrderBook book_;
+    BookView view_;
+
+    std::uint64_t now_ = 0;              // Engine clock (ms); the only time the book ever sees
+    std::uint64_t day_close_ = 0;        // Tick at which DAY orders expire (stamped by the primary)
+    std::uint64_t sequence_ = 0;
+    std::atomic<std::uint64_t> applied_sequence_{0};
+    ReplicationPublisher* replication_ = nullptr;
+    bool replica_ = false;
+    bool busy_poll_ = false;
+
+    bool in_auction_ = false;
+    double last_trade_price_ = 0.0;
+
+    // Snapshot being restored on a standby
+    std::uint32_t restoring_ = 0;  // Orders still to come
+    std::vector<std::pair<TimerPosition, RestingOrder*>> restored_timers_;
 };
@@ -5,11 +5,22 @@
 #include <memory>
 #include <stdexcept>
 #include <cstdint>
+#include <atomic>
+#include <optional>
 
 
 // --- Enums for order direction and type ---
 enum class OrderSide { BUY, SELL };
 enum class OrderType { LIMIT };
+enum class TimeInForce { GTC, DAY, GTD };
+
+// --- Identifier limits: fixed-width records (replication, shared memory) hold IDs this long in full ---
+constexpr std::size_t kMaxClientIdLength = 23;  // Longer client IDs are rejected at the gateway
+constexpr std::size_t kMaxOrderIdLength = 23;   // "ORD" plus the 20 digits of a 64-bit counter
+
+// --- Gateway session handle, assigned at connect time ---
+using SessionId = std::uint32_t;
+constexpr SessionId kNoSession = 0;
 
 // --- Lightweight utility functions ---
 inline std::string to_string(OrderSide side) {
@@ -22,9 +33,48 @@ inline OrderSide parse_order_side(const std::string& str) {
     throw std::invalid_argument("Invalid OrderSide: " + str);
 }
 
+inline std::string to_string(TimeInForce tif) {
+    switch (tif) {
+        case TimeInForce::DAY: return "DAY";
+        case TimeInForce::GTD: return "GTD";
+        default: return "GTC";
+    }
+}
+
+inline TimeInForce parse_time_in_force(const std::string& str) {
+    if (str.empty() || str == "GTC") return TimeInForce::GTC;
+    if (str == "DAY") return TimeInForce::DAY;
+    if (str == "GTD") return TimeInForce::GTD;
+    throw std::invalid_argument("Invalid TimeInForce: " + str);
+}
+
+// Last order number handed out by generate_order_id()
+inline std::atomic<uint64_t>& order_id_counter() {
+    static std::atomic<uint64_t> counter{0};
+    return counter;
+}
+
 inline std::string generate_order_id() {
-    static uint64_t counter = 0;
-    return "ORD" + std::to_string(++counter);
+    // Called concurrently from every client handler thread
+    return "ORD" + std::to_string(++order_id_counter());
+}
+
+// --- Number of an "ORD<n>" ID, or 0 if the ID was not generated here ---
+inline uint64_t order_id_number(const char* order_id) {
+    if (order_id[0] != 'O' || order_id[1] != 'R' || order_id[2] != 'D' || order_id[3] == '\0') return 0;
+    uint64_t number = 0;
+    for (const char* digit = order_id + 3; *digit; ++digit) {
+        if (*digit < '0' || *digit > '9') return 0;
+        number = number * 10 + static_cast<uint64_t>(*digit - '0');
+    }
+    return number;
+}
+
+// --- Makes generate_order_id() continue above `highest` (a promoted standby) ---
+inline void reserve_order_ids(uint64_t highest) {
+    auto& counter = order_id_counter();
+    uint64_t current = counter.load();
+    while (current < highest && !counter.compare_exchange_weak(current, highest)) {}
 }
 
 inline std::chrono::system_clock::time_point current_timestamp() {
@@ -48,8 +98,18 @@ public:
     double price() const { return price_; }
     OrderType type() const { return type_; }
     std::chrono::system_clock::time_point timestamp() const { return timestamp_; }
+    SessionId session_id() const { return session_id_; }
+    TimeInForce time_in_force() const { return time_in_force_; }
+    std::chrono::system_clock::time_point expire_time() const { return expire_time_; }
 
     void set_quantity(int q) { quantity_ = q; }
+    void set_session_id(SessionId session) { session_id_ = session; }
+
+    /// GTD requires an expiry; for DAY the engine fills in the session close
+    void set_time_in_force(TimeInForce tif, std::chrono::system_clock::time_point expire_time = {}) {
+        time_in_force_ = tif;
+        expire_time_ = expire_time;
+    }
 
     virtual std::string to_string() const;
 
@@ -61,8 +121,70 @@ private:
     double price_;
     OrderType type_;
     std::chrono::system_clock::time_point timestamp_;
+    SessionId session_id_ = kNoSession;
+    TimeInForce time_in_force_ = TimeInForce::GTC;
+    std::chrono::system_clock::time_point expire_time_{};
 };
 
+// --- Selects which of a client's resting orders a mass cancel removes ---
+struct CancelFilter {
+    std::optional<OrderSide> side;  ///< Only this side (both sides if empty)
+    double price = 0.0;             ///< Only this price (every price if 0)
+
+    bool matches(const Order& order) const {
+        return (!side || order.side() == *side) && (price <= 0.0 || order.price() == price);
+    }
+};
+
+// --- Parses "CANCEL_ALL[,SIDE[,PRICE]]"; returns false if the line is not a mass cancel ---
+inline bool parse_cancel_all(const std::string& line, CancelFilter& filter) {
+    static const std::string kVerb = "CANCEL_ALL";
+    if (line.compare(0, kVerb.size(), kVerb) != 0) return false;
+    if (line.size() > kVerb.size() && line[kVerb.size()] != ',') return false;
+
+    filter = {};
+    std::size_t start = kVerb.size() + 1;
+    if (start >= line.size()) return true;
+
+    const std::size_t comma = line.find(',', start);
+    filter.side = parse_order_side(line.substr(start, comma - start));
+    if (comma != std::string::npos) filter.price = std::stod(line.substr(comma + 1));
+    return true;
+}
+
+// --- Why the gateway refused an order before it reached the engine ---
+enum class RejectReason : std::uint8_t {
+    NONE,
+    CLIENT_ID,       ///< Empty, or longer than kMaxClientIdLength
+    SIDE,
+    QUANTITY,        ///< Not a positive integer
+    PRICE,           ///< Not a positive, finite number
+    TIME_IN_FORCE,
+    EXPIRY,          ///< GTD lifetime out of range
+    MALFORMED        ///< Could not be parsed at all
+};
+
+// --- Longest GTD lifetime accepted, so expiry arithmetic cannot overflow ---
+constexpr long long kMaxGtdSeconds = 366LL * 24 * 60 * 60;
+
+inline std::string to_string(RejectReason reason) {
+    switch (reason) {
+        case RejectReason::CLIENT_ID:
+            return "client ID must be 1 to " + std::to_string(kMaxClientIdLength) + " characters";
+        case RejectReason::SIDE: return "side must be BUY or SELL";
+        case RejectReason::QUANTITY: return "quantity must be a positive integer";
+        case RejectReason::PRICE: return "price must be a positive number";
+        case RejectReason::TIME_IN_FORCE: return "time in force must be GTC, DAY or GTD";
+        case RejectReason::EXPIRY: return "GTD expiry must be 1 to " + std::to_string(kMaxGtdSeconds) + " seconds";
+        case RejectReason::MALFORMED: return "malformed order";
+        default: return "accepted";
+    }
+}
+
+// --- Checks the fields of an incoming order; side and time in force are checked when decoded ---
+RejectReason validate_order(const std::string& client_id, double price, long long quantity,
+                            TimeInForce tif, long long expiry_seconds);
+
 // --- Parses a command-line string into an Order object ---
 // Format: "BUY 5 100.0" or "SELL 10 101.5"
 std::unique_ptr<Order> parse_order(const std::string& client_id, const std::string& input_line);
@@ -1,46 +1,145 @@
 #pragma once
 
-#include <map>
-#include <deque>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include "order.hpp"
+#include "trade.hpp"
+#include "half_book.hpp"
+
+/**
+ * @brief Outcome of an auction price determination.
+ */
+struct AuctionResult {
+    double price = 0.0;       ///< Equilibrium price (0 if the book does not cross)
+    long long volume = 0;     ///< Quantity executable at that price
+    long long imbalance = 0;  ///< Surplus demand (+) or supply (-) at that price
+};
 
 /**
  * @brief Manages a limit order book.
- * 
+ *
  * Stores buy and sell orders in price levels, and matches incoming orders
  * against the opposite side of the book using price-time priority.
+ * Each side is a HalfBook specialised on its direction; the side of an
+ * incoming order is dispatched once, at entry.
  */
 class OrderBook {
 public:
+    OrderBook();
+
+    // Orders and levels point into the arena and at each other
+    OrderBook(const OrderBook&) = delete;
+    OrderBook& operator=(const OrderBook&) = delete;
+
+    /**
+     * @brief Node memory behind both sides; reserve() it before the first order.
+     */
+    BookArena& memory() { return arena_; }
+
     /**
      * @brief Add an unmatched order to the appropriate side of the book.
+     *
+     * Orders carrying a session are also linked into that session's order list.
+     *
+     * @return The resting order; valid until it is filled or removed
+     */
+    RestingOrder& add_order(Order order);
+
+    /**
+     * @brief Remove a resting order (cancel or expiry).
      */
-    void add_order(const Order& order);
+    void remove_order(RestingOrder& order);
+
+    /**
+     * @brief Removes every resting order (a standby restoring a snapshot).
+     *
+     * Each order cancels its own expiry timer as it goes.
+     */
+    void clear();
+
+    /**
+     * @brief Cancels a session's resting orders that match `filter`.
+     *
+     * Walks only that session's own orders, never the price levels.
+     * `on_cancel(const RestingOrder&)` is called for each order just before
+     * it is removed.
+     *
+     * @return Number of orders canceled
+     */
+    template<typename OnCancel>
+    std::size_t cancel_session_orders(SessionId session, const CancelFilter& filter, OnCancel&& on_cancel) {
+        auto list = client_orders_.find(session);
+        if (list == client_orders_.end()) return 0;
+
+        std::size_t canceled = 0;
+        list->second.for_each([&](ClientOrderNode& node) {
+            RestingOrder& order = static_cast<RestingOrder&>(node);
+            if (!filter.matches(order)) return;
+            on_cancel(static_cast<const RestingOrder&>(order));
+            remove_from_side(order);  // Not remove_order(): the list must outlive this walk
+            ++canceled;
+        });
+
+        if (list->second.empty()) client_orders_.erase(list);
+        return canceled;
+    }
 
     /**
      * @brief Attempt to match an incoming order with the opposite side.
-     * 
-     * @param incoming The order to match
-     * @return A list of matched (consumed) orders
+     *
+     * @param incoming The order to match; left holding its unfilled quantity
+     * @return One trade per fill, in execution order
      */
-    std::vector<Order> match_order(Order& incoming);
+    std::vector<Trade> match_order(Order& incoming);
 
     /**
-     * @return Read-only access to current buy-side levels
+     * @brief Computes the call-auction equilibrium price for the current book.
+     *
+     * Chooses the price that maximises executable volume, then minimises the
+     * absolute imbalance, then is closest to the reference price. Works on
+     * cumulative depth arrays over the merged price ladder.
+     *
+     * @param reference_price Tie-break price; if <= 0 the midpoint of best bid and ask is used
      */
-    const auto& buy_orders() const { return buy_orders_; }
+    AuctionResult compute_auction(double reference_price) const;
 
     /**
-     * @return Read-only access to current sell-side levels
+     * @brief Executes the auction: crosses all executable quantity at a single price.
+     *
+     * @param reference_price See compute_auction()
+     * @param result Receives the price determination that was executed
+     * @return The resulting trades, all at `result.price`
      */
-    const auto& sell_orders() const { return sell_orders_; }
+    std::vector<Trade> uncross(double reference_price, AuctionResult& result);
+
+    /**
+     * @return Read-only access to current buy-side levels (highest price first)
+     */
+    const auto& buy_orders() const { return bids_.levels(); }
+
+    /**
+     * @return Read-only access to current sell-side levels (lowest price first)
+     */
+    const auto& sell_orders() const { return asks_.levels(); }
+
+    /**
+     * @brief Sessions that have at least one resting order, in no particular order.
+     */
+    std::vector<SessionId> sessions() const;
 
 private:
-    // Buy side (stored lowest→highest, but accessed in reverse to get highest price first)
-    std::map<double, std::deque<Order>> buy_orders_;
+    /// Unlinks an order from its side only, leaving its session's list entry in place
+    void remove_from_side(RestingOrder& order);
+
+    /// Drops a session's list once its last order has left the book
+    void release_session(SessionId session);
+
+    BookArena arena_;  // Declared first so it outlives every node allocated from it
 
-    // Sell side: lowest price first
-    std::map<double, std::deque<Order>> sell_orders_;
+    // Declared before the sides so every order has unlinked itself by the time the lists go.
+    // Only sessions with resting orders have an entry: whatever empties a list erases it.
+    std::unordered_map<SessionId, ClientOrderList> client_orders_;
+    HalfBook<OrderSide::BUY> bids_;
+    HalfBook<OrderSide::SELL> asks_;
 };
@@ -2,7 +2,13 @@
 
 #include "order.hpp"
 #include "trade.hpp"
+#include "execution_report.hpp"
+#include "engine_event.hpp"
 #include "thread_safe_queue.hpp"
+#include "spsc_queue.hpp"
+#include "shm_channel.hpp"
+#include "book_view.hpp"
+#include "trade_analytics.hpp"
 
 #include "platform.hpp"
 
@@ -11,20 +17,25 @@
 #include <vector>
 #include <thread>
 #include <atomic>
-#include <unordered_map>
+#include <array>
+#include <memory>
 #include <mutex>
 
 /**
  * @brief TCP-based order server that accepts clients,
- *        receives incoming orders, and sends trade confirmations.
+ *        receives incoming orders, and sends execution reports.
  */
 class OrderServer {
 public:
     /**
      * @param input_queue Thread-safe queue for submitting orders to the matching engine
+     * @param report_queue Thread-safe queue of execution reports produced by the matching engine
      * @param port Listening port for incoming client connections (default: 54000)
+     * @param first_session_id First session handle to hand out; a promoted standby starts
+     *        above the old primary's handles so their reports never reach new sessions
      */
-    OrderServer(ThreadSafeQueue<Order>& input_queue, ThreadSafeQueue<Trade>& trade_queue, int port = 54000);
+    OrderServer(ThreadSafeQueue<EngineEvent>& input_queue, ThreadSafeQueue<ExecutionReport>& report_queue, int port = 54000,
+                SessionId first_session_id = 1);
     ~OrderServer();
 
     /// Starts the server: accepts clients and spawns handler threads
@@ -36,27 +47,103 @@ public:
     /// Writes all completed trades to a CSV file
     void write_trade_log_to_file(const std::string& filename) const;
 
+    /// Answers STATUS and BOOK client queries from the engine's view. Call before start()
+    void set_book_view(const BookView* view) { book_view_ = view; }
+
+    /// Feeds every routed trade to an analytics stage. Call before start()
+    void set_trade_analytics(TradeAnalytics* analytics) { analytics_ = analytics; }
+
+    /**
+     * @brief Pins the accept thread and the report router to one core. Call before start()
+     *
+     * The accept thread only blocks in accept(), so the router effectively
+     * has the core to itself. Session readers and writers are left unpinned;
+     * they back off when idle, so they never hold a core between bursts.
+     */
+    void set_cpu_core(int core) { cpu_core_ = core; }
+
+    /// Spins, rather than sleeping, in the report router; session writers spin briefly before backing off. Call before start()
+    void set_busy_poll(bool busy_poll) { busy_poll_ = busy_poll; }
+
 private:
     /// Accepts new clients and dispatches handlers
     void accept_clients();
 
     /// Handles individual client session (receiving orders)
-    void handle_client(SOCKET client_socket);
+    void handle_client(SessionId session_id);
+
+    /// Drains one session's outbound queue onto its socket (or shared-memory ring)
+    void write_session(SessionId session_id);
+
+    /// Routes execution reports into the per-session outbound queues
+    void route_reports();
+
+    /// Answers a "STATUS,<order_id>" or "BOOK" line from the book view; false if `line` is not exactly a query
+    bool answer_query(const std::string& line, std::string& reply) const;
+
+private:
+    static constexpr std::size_t kMaxSessions = 256;
+    static constexpr std::size_t kOutboundCapacity = 4096;
+    static constexpr std::size_t kReplyCapacity = 256;
+
+    /**
+     * @brief One connected client.
+     *
+     * Slots are allocated once and reused; `handle` identifies the current
+     * occupant so reports addressed to a previous occupant are dropped.
+     * `outbound` has a single producer (the response thread) and a single
+     * consumer (the session's writer thread). `replies` carries acks, rejects
+     * and query answers from the session's reader thread to the same writer.
+     *
+     * A co-located client may switch the session to shared memory with an
+     * "SHM" handshake as its first line; orders and reports then travel
+     * through `shm` and the socket only signals liveness. Requests that fail
+     * validation are answered through `shm_replies` instead of `replies`.
+     *
+     * A full reply queue disconnects the client rather than lose an ACK or
+     * REJECT; only query answers are ever dropped.
+     */
+    struct Session {
+        std::atomic<SessionId> handle{kNoSession};
+        std::atomic<bool> open{false};
+        SOCKET socket = INVALID_SOCKET;
+        SpscQueue<ExecutionReport, kOutboundCapacity> outbound;
+        SpscQueue<std::string, kReplyCapacity> replies;
+        SpscQueue<ShmReportMessage, kReplyCapacity> shm_replies;
+        std::unique_ptr<ShmChannel> shm;                 // Owned by the reader thread
+        std::atomic<ShmRegion*> shm_region{nullptr};     // What the writer thread sees
+    };
+
+    /// Creates the session's shared-memory channel and answers the handshake
+    bool open_shm_channel(Session& session, SessionId session_id);
+
+    /// Polls the session's inbound ring until the client disconnects
+    void poll_shm_channel(Session& session, SessionId session_id);
+
+    /// Why a shared-memory request must be refused, or NONE if it can go to the engine
+    static RejectReason check_shm_request(const ShmOrderMessage& message);
+
+    /// Claims a free session slot for a new connection (accept thread only)
+    SessionId open_session(SOCKET client_socket);
 
-    /// Sends matched trade confirmations back to clients
-    void send_trade_responses();
+    /// Returns the live session for a handle, or nullptr if it has gone away
+    Session* find_session(SessionId session_id) const;
 
 private:
     int port_;
     SOCKET listen_socket_ = INVALID_SOCKET;
     std::atomic<bool> running_{true};
 
-    // Map client ID → socket
-    std::unordered_map<std::string, SOCKET> client_sockets_;
-    mutable std::mutex socket_mutex_;
+    // Session table indexed by handle % kMaxSessions
+    std::array<std::unique_ptr<Session>, kMaxSessions> sessions_;
+    SessionId next_session_id_;
 
-    ThreadSafeQueue<Order>& input_queue_;
-    ThreadSafeQueue<Trade>& trade_queue_;
+    ThreadSafeQueue<EngineEvent>& input_queue_;
+    ThreadSafeQueue<ExecutionReport>& report_queue_;
+    const BookView* book_view_ = nullptr;
+    TradeAnalytics* analytics_ = nullptr;
+    int cpu_core_ = -1;
+    bool busy_poll_ = false;
 
     std::thread accept_thread_;
     std::thread response_thread_;
@@ -8,6 +8,7 @@
     #include <sys/socket.h>
     #include <arpa/inet.h>
     #include <netinet/in.h>
+    #include <netinet/tcp.h>
     #include <unistd.h>
     #define SOCKET int
     #define INVALID_SOCKET -1
@@ -15,3 +16,11 @@
     #define closesocket close
     #define SD_BOTH SHUT_RDWR
 #endif
+
+// Spin-wait hint for busy-poll loops
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #include <immintrin.h>
+    inline void cpu_relax() { _mm_pause(); }
+#else
+    inline void cpu_relax() {}
+#endif
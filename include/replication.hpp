@@ -0,0 +1,276 @@
+#pragma once
+
+#include "engine_event.hpp"
+#include "spsc_queue.hpp"
+#include "thread_safe_queue.hpp"
+#include "platform.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Fixed-size wire image of one sequenced engine input.
+ *
+ * Sent as raw bytes, so primary and standby must share endianness and
+ * layout (same build, typically the same host or rack). The ID fields hold
+ * the longest IDs the gateway accepts, so nothing is truncated.
+ *
+ * A snapshot is a SNAPSHOT record followed by one RESTORE_ORDER record per
+ * resting order, all carrying the sequence they were taken at.
+ */
+struct ReplicationRecord {
+    std::uint64_t sequence;       ///< Engine input sequence number (1-based, gap-free)
+    std::uint64_t tick;           ///< Engine clock (ms) at which the primary applied the event
+    std::uint64_t sent_ns;        ///< Primary wall clock (ns) when published, for lag tracking
+    std::uint64_t expire_tick;    ///< Order expiry (ms since epoch), 0 for GTC; SNAPSHOT: DAY close
+    std::uint64_t timer_tick;     ///< SNAPSHOT: expiry wheel position
+    std::uint64_t order_number;   ///< SNAPSHOT: highest order number handed out
+    double price;                 ///< Limit price, CANCEL_CLIENT price filter; SNAPSHOT: last trade price
+    double reference_price;
+    std::int32_t quantity;        ///< SNAPSHOT: number of RESTORE_ORDER records that follow
+    SessionId session;
+    std::uint32_t timer_rank;     ///< RESTORE_ORDER: see TimerPosition
+    std::uint8_t timer_level;
+    std::uint8_t timer_slot;
+    std::uint8_t type;
+    std::uint8_t side;
+    std::uint8_t time_in_force;
+    std::uint8_t side_filter;     ///< CANCEL_CLIENT: 1 if only `side` is canceled; SNAPSHOT: in auction
+    char order_id[24];
+    char client_id[24];
+
+    static ReplicationRecord from_event(const EngineEvent& event);
+
+    /// One resting order of a snapshot taken at `sequence`
+    static ReplicationRecord restore(const Order& order, std::uint64_t sequence, const TimerPosition& timer);
+
+    EngineEvent to_event() const;
+};
+
+static_assert(std::is_trivially_copyable<ReplicationRecord>::value,
+              "ReplicationRecord is sent as raw bytes");
+static_assert(sizeof(ReplicationRecord::order_id) > kMaxOrderIdLength &&
+              sizeof(ReplicationRecord::client_id) > kMaxClientIdLength,
+              "ReplicationRecord must carry IDs without truncating them");
+
+/// Resume point a standby sends when it needs a snapshot rather than a resend
+constexpr std::uint64_t kResumeFromSnapshot = UINT64_MAX;
+
+/**
+ * @brief Primary side: streams the engine's sequenced input to standbys.
+ *
+ * The engine thread only encodes a record into a lock-free ring. A separate
+ * publisher thread drains the ring in batches into an in-memory journal and
+ * pipelines it to every connected standby without waiting for acks.
+ *
+ * A standby opens each connection by sending the last sequence it holds and
+ * then keeps acknowledging what it receives (8-byte sequence numbers), so a
+ * standby that drops off reconnects and is resent the journal from where it
+ * left off.
+ *
+ * The journal is bounded. Snapshots are built off the engine thread: the
+ * publisher feeds every journaled record to a replica engine of its own,
+ * which streams its book back on request, every kSnapshotInterval records.
+ * Records up to the latest snapshot are dropped once every standby has
+ * acknowledged them, or regardless once the journal exceeds kMaxJournal. A
+ * standby whose resume point is no longer journaled is sent the snapshot and
+ * then the tail from there.
+ *
+ * Endpoints are "host:port" for TCP or "unix:/path" for a Unix domain socket.
+ */
+class ReplicationPublisher {
+public:
+    explicit ReplicationPublisher(std::string endpoint);
+    ~ReplicationPublisher();
+
+    /// Binds the endpoint and starts the accept and publisher threads
+    bool start();
+
+    /// Stops accepting standbys, flushes what is queued, and joins threads
+    void stop();
+
+    /// Pins the publisher and accept threads to one core. Call before start()
+    void set_cpu_core(int core) { cpu_core_ = core; }
+
+    /**
+     * @brief Engine thread only. Queues one sequenced event for replication.
+     *
+     * Spins (rather than dropping) if the ring is full, since a gap would
+     * make every standby diverge.
+     */
+    void publish(const EngineEvent& event);
+
+    /// Snapshot builder only. Queues the SNAPSHOT header of a snapshot being taken
+    void publish_snapshot(const EngineEvent& header);
+
+    /// Snapshot builder only. Queues one resting order of the snapshot just started
+    void publish_restore(const Order& order, std::uint64_t sequence, const TimerPosition& timer);
+
+    /// Highest sequence handed over by the engine
+    std::uint64_t published_sequence() const { return published_sequence_.load(std::memory_order_relaxed); }
+
+    /// Highest sequence written to every connected standby
+    std::uint64_t sent_sequence() const { return sent_sequence_.load(std::memory_order_relaxed); }
+
+    /// Highest sequence every connected standby has acknowledged
+    std::uint64_t acked_sequence() const { return acked_sequence_.load(std::memory_order_relaxed); }
+
+    /// Number of connected standbys
+    std::size_t standby_count() const;
+
+private:
+    static constexpr std::size_t kRingCapacity = 1 << 16;
+    static constexpr std::size_t kSnapshotRingCapacity = 1 << 12;
+    static constexpr std::size_t kMaxBatch = 512;
+    static constexpr std::uint64_t kSnapshotInterval = 1 << 16;  // Records between snapshots
+    static constexpr std::size_t kMaxJournal = 1 << 18;          // Records kept for slow standbys
+
+    using Snapshot = std::vector<ReplicationRecord>;  // SNAPSHOT record, then its RESTORE_ORDERs
+
+    struct SnapshotBuilder;  // Replica engine following the journal on its own thread
+
+    struct Standby {
+        SOCKET socket;
+        std::uint64_t next = 0;     ///< Next sequence to send (0 until the standby is positioned)
+        std::uint64_t acked = 0;    ///< Highest sequence the standby has acknowledged
+        bool resumed = false;       ///< True once its resume point has arrived
+        char ack[sizeof(std::uint64_t)] = {};
+        std::size_t ack_filled = 0;
+        std::shared_ptr<const Snapshot> snapshot = nullptr;  ///< Being sent ahead of `next`, if any
+        std::size_t snapshot_sent = 0;
+    };
+
+    void accept_standbys();
+    void stream();
+
+    /// Reads whatever acks a standby has sent, without blocking; false if it has gone away
+    bool read_acks(Standby& standby);
+
+    /// Positions a standby at its resume point and sends it the next batch; false to drop it
+    bool serve(Standby& standby, bool& sent_any);
+
+    /// Resumes a standby from the journal, or from the latest snapshot; false if it must wait for one
+    bool position(Standby& standby, std::uint64_t resume);
+
+    /// Files one record of the snapshot the builder is streaming
+    void collect_snapshot(const ReplicationRecord& record);
+
+    /// Asks the builder for a snapshot as of the last journaled record, unless one is on its way
+    void request_snapshot();
+
+    /// Drops what no standby needs, asks for a snapshot when one is due
+    void trim_journal(std::uint64_t needed);
+
+    /// Sequence the latest complete snapshot was taken at (0 if none)
+    std::uint64_t snapshot_sequence() const { return snapshot_ ? snapshot_->front().sequence : 0; }
+
+    /// One past the last journaled sequence
+    std::uint64_t journal_end() const { return journal_front_ + journal_.size(); }
+
+    std::string endpoint_;
+    SOCKET listen_socket_ = INVALID_SOCKET;
+    std::atomic<bool> running_{false};
+    int cpu_core_ = -1;
+
+    SpscQueue<ReplicationRecord, kRingCapacity> ring_;
+    std::atomic<std::uint64_t> published_sequence_{0};
+    std::atomic<std::uint64_t> sent_sequence_{0};
+    std::atomic<std::uint64_t> acked_sequence_{0};
+    SpscQueue<ReplicationRecord, kSnapshotRingCapacity> snapshot_ring_;  // Builder to publisher thread
+    std::unique_ptr<SnapshotBuilder> builder_;
+
+    // Publisher thread only
+    std::deque<ReplicationRecord> journal_;    // Contiguous sequences starting at journal_front_
+    std::uint64_t journal_front_ = 1;
+    std::shared_ptr<const Snapshot> snapshot_; // Latest complete snapshot
+    Snapshot building_;                        // Snapshot still arriving from the builder
+    std::size_t building_remaining_ = 0;
+    bool snapshot_pending_ = false;            // Requested and not yet complete
+    std::vector<ReplicationRecord> batch_;     // Staging for one send
+    std::vector<Standby> standbys_;
+
+    std::vector<SOCKET> pending_standbys_;    // Handed over by the accept thread
+    mutable std::mutex standby_mutex_;
+    std::size_t standby_count_ = 0;
+
+    std::thread accept_thread_;
+    std::thread publisher_thread_;
+};
+
+/**
+ * @brief Standby side: receives the primary's stream and feeds a local engine.
+ *
+ * Records are decoded into EngineEvents and pushed, in order, onto the
+ * standby engine's input queue. The engine must be in replica mode so it
+ * takes time from the stream instead of its own clock.
+ *
+ * Only a gap-free stream is applied. If the connection drops, or a record
+ * arrives out of sequence, the receiver stops applying, reconnects and asks
+ * the primary to resend from the last sequence it holds, until stop(). A
+ * snapshot replaces everything applied before it; one cut short leaves the
+ * standby inconsistent until a complete snapshot has been received.
+ */
+class ReplicaReceiver {
+public:
+    ReplicaReceiver(std::string endpoint, ThreadSafeQueue<EngineEvent>& engine_queue);
+    ~ReplicaReceiver();
+
+    /// Connects to the primary and starts the receive thread; false if the first connect fails
+    bool start();
+
+    /// Disconnects from the primary, stops reconnecting and joins the receive thread
+    void stop();
+
+    /// Pins the receive thread to one core. Call before start()
+    void set_cpu_core(int core) { cpu_core_ = core; }
+
+    /// True while connected to the primary
+    bool connected() const { return connected_.load(std::memory_order_acquire); }
+
+    /// Highest sequence received from the primary (everything up to it has been applied in order)
+    std::uint64_t received_sequence() const { return received_sequence_.load(std::memory_order_relaxed); }
+
+    /// False while a snapshot is only partly received; such a standby must not be promoted
+    bool consistent() const { return restoring_.load(std::memory_order_acquire) == 0; }
+
+    /// Publish-to-receive latency of the most recent record, in microseconds
+    double last_lag_us() const { return last_lag_ns_.load(std::memory_order_relaxed) / 1000.0; }
+
+    /// Highest gateway session handle seen in the stream
+    SessionId highest_session() const { return highest_session_.load(std::memory_order_relaxed); }
+
+    /// Highest "ORD<n>" order number seen in the stream; a promoted standby numbers new orders above it
+    std::uint64_t highest_order_number() const { return highest_order_number_.load(std::memory_order_relaxed); }
+
+private:
+    void receive();
+
+    /// Applies records from the current connection until it drops or goes out of sequence
+    void follow();
+
+    /// Connects again, retrying until it succeeds or stop() is called
+    bool reconnect();
+
+    std::string endpoint_;
+    ThreadSafeQueue<EngineEvent>& engine_queue_;
+    SOCKET socket_ = INVALID_SOCKET;   // Replaced by the receive thread; shut down by stop()
+    std::mutex socket_mutex_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> connected_{false};
+    int cpu_core_ = -1;
+
+    std::atomic<std::uint64_t> received_sequence_{0};
+    std::atomic<std::uint32_t> restoring_{0};  // Snapshot orders still to come
+    std::atomic<std::int64_t> last_lag_ns_{0};
+    std::atomic<SessionId> highest_session_{kNoSession};
+    std::atomic<std::uint64_t> highest_order_number_{0};
+
+    std::thread receive_thread_;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "platform.hpp"
+
+/**
+ * @brief How the process trades CPU and memory for latency.
+ */
+enum class RuntimeMode {
+    POWER_SAVING,  ///< Threads block when idle; memory is demand-paged (default)
+    LOW_LATENCY    ///< Engine and gateway busy-poll; book memory is pre-faulted, locked and huge-page backed
+};
+
+inline std::string to_string(RuntimeMode mode) {
+    return (mode == RuntimeMode::LOW_LATENCY) ? "low-latency" : "power-saving";
+}
+
+/**
+ * @brief Per-deployment runtime settings, chosen on the command line.
+ *
+ * Core pinning applies in either mode when cores are given; everything
+ * else only takes effect in LOW_LATENCY.
+ */
+struct RuntimeProfile {
+    RuntimeMode mode = RuntimeMode::POWER_SAVING;
+    int engine_core = -1;                  ///< Core for the matching engine (-1 = not pinned)
+    int gateway_core = -1;                 ///< Core for the order server's router and accept threads
+    int publisher_core = -1;               ///< Core for replication publishing
+    int analytics_core = -1;               ///< Core for the trade analytics thread
+    std::size_t book_memory_mb = 256;      ///< Book memory reserved and pre-faulted up front
+    bool hugepages = true;                 ///< Back book memory with huge pages where available
+    bool lock_memory = true;               ///< mlock() book memory
+    std::chrono::milliseconds jitter_probe{250};  ///< Idle-spin probe on the engine core at startup (0 = off)
+
+    bool low_latency() const { return mode == RuntimeMode::LOW_LATENCY; }
+
+    /**
+     * @brief Applies one command-line option.
+     *
+     *   --profile low-latency|power-saving
+     *   --cores ENGINE[,GATEWAY[,PUBLISHER[,ANALYTICS]]]
+     *   --book-mb N
+     *   --hugepages on|off, --mlock on|off
+     *   --jitter-ms N
+     *
+     * @return False if `flag` is not a profile option
+     * @throws std::invalid_argument on a malformed value
+     */
+    bool parse_option(const std::string& flag, const std::string& value);
+
+    /// One-line summary for the startup banner
+    std::string describe() const;
+};
+
+/**
+ * @brief Idle strategy for a thread polling a lock-free ring.
+ *
+ * The thread spins briefly, so a burst is still picked up without a
+ * wake-up, then yields, then sleeps `sleep` per empty poll until work
+ * returns. Used by per-session threads, which are unpinned and two per
+ * client, so they back off even under busy polling.
+ */
+class IdleBackoff {
+public:
+    explicit IdleBackoff(std::chrono::microseconds sleep) : sleep_(sleep) {}
+
+    /// Called after a poll that found nothing. Returns true if it slept
+    bool idle() {
+        if (idle_polls_ < kSpinPolls) {
+            ++idle_polls_;
+            cpu_relax();
+            return false;
+        }
+        if (idle_polls_ < kSpinPolls + kYieldPolls) {
+            ++idle_polls_;
+            std::this_thread::yield();
+            return false;
+        }
+        std::this_thread::sleep_for(sleep_);
+        return true;
+    }
+
+    /// Called after a poll that found work
+    void reset() { idle_polls_ = 0; }
+
+private:
+    static constexpr std::uint32_t kSpinPolls = 4096;
+    static constexpr std::uint32_t kYieldPolls = 64;
+
+    std::chrono::microseconds sleep_;
+    std::uint32_t idle_polls_ = 0;
+};
+
+/**
+ * @brief Pins the calling thread to one CPU core.
+ *
+ * @return False if `core` is negative, or pinning is unsupported or refused
+ */
+bool pin_current_thread(int core);
+
+/// Pins the calling thread if `core` is set (not -1); logs when that fails rather than failing silently
+void pin_current_thread_or_warn(int core, const char* thread_name);
+
+/**
+ * @brief Scheduling noise seen by a thread spinning on the clock.
+ */
+struct JitterReport {
+    std::uint64_t samples = 0;
+    std::uint64_t min_gap_ns = 0;      ///< Cost of one clock read
+    std::uint64_t max_gap_ns = 0;      ///< Longest interruption
+    std::uint64_t gaps_over_1us = 0;
+    std::uint64_t gaps_over_10us = 0;
+    std::uint64_t gaps_over_100us = 0;
+    std::uint64_t stolen_ns = 0;       ///< Total time in gaps over 1 us
+    std::uint64_t elapsed_ns = 0;
+
+    std::string to_string() const;
+};
+
+/**
+ * @brief Spins on `core` for `duration`, timing the gaps between consecutive clock reads.
+ *
+ * Gaps far above the clock-read cost are interrupts, preemption or SMIs
+ * that the engine would also suffer on that core.
+ */
+JitterReport measure_jitter(int core, std::chrono::milliseconds duration);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Single-writer sequence lock publishing a trivially copyable value.
+ *
+ * The writer never blocks and never waits for readers. Readers copy the
+ * value and retry if a write overlapped the copy, so they never block the
+ * writer either. The payload is stored as relaxed atomic words, which keeps
+ * the overlapping read well-defined.
+ *
+ * The writer also keeps a private copy so it can update a value in place
+ * without reading back through the seqlock.
+ */
+template<typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+
+public:
+    Seqlock() { store(T{}); }
+
+    // Non-copyable
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    /**
+     * @brief Writer only. Publishes a new value.
+     */
+    void store(const T& value) {
+        value_ = value;
+        publish();
+    }
+
+    /**
+     * @brief Writer only. Applies `mutate(T&)` to the current value and publishes it.
+     */
+    template<typename Mutate>
+    void update(Mutate&& mutate) {
+        mutate(value_);
+        publish();
+    }
+
+    /**
+     * @brief Writer only. The value as last written.
+     */
+    const T& writer_value() const { return value_; }
+
+    /**
+     * @brief Any thread. Returns a consistent copy of the latest value.
+     */
+    T load() const {
+        std::uint64_t buffer[kWords];
+        std::uint64_t before;
+        do {
+            before = sequence_.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < kWords; ++i) {
+                buffer[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((before & 1) != 0 || before != sequence_.load(std::memory_order_relaxed));
+
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    void publish() {
+        std::uint64_t buffer[kWords] = {};
+        std::memcpy(buffer, &value_, sizeof(T));
+
+        const std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);  // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<std::uint64_t> sequence_{0};
+    std::atomic<std::uint64_t> words_[kWords];
+    T value_{};
+};
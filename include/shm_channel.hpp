@@ -0,0 +1,157 @@
+#pragma once
+
+#include "order.hpp"
+#include "trade.hpp"
+#include "execution_report.hpp"
+#include "spsc_queue.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief Binary request as written by a co-located client into shared memory.
+ *
+ * Either a new order, or a mass cancel of the session's resting orders
+ * (filtered by `side` if `side_filter` is set, and by `price` if non-zero).
+ */
+struct ShmOrderMessage {
+    enum Kind : std::uint8_t { NEW_ORDER = 0, CANCEL_ALL = 1 };
+
+    char client_id[24];
+    double price;
+    std::int32_t quantity;
+    std::uint8_t side;            ///< OrderSide
+    std::uint8_t time_in_force;   ///< TimeInForce
+    std::uint8_t kind;            ///< Kind
+    std::uint8_t side_filter;     ///< CANCEL_ALL: 1 if only `side` is canceled
+    std::int64_t expiry_seconds;  ///< GTD lifetime, ignored otherwise
+};
+
+/**
+ * @brief Binary execution report written by the server into shared memory.
+ *
+ * For a TRADE both client IDs are set. For an order closed without trading,
+ * only the ID on the order's side is set and `quantity` is what was left.
+ * A REJECTED request never reached the engine; `reason` says why.
+ */
+struct ShmReportMessage {
+    enum Kind : std::uint8_t { TRADE = 0, CANCELED = 1, EXPIRED = 2, REJECTED = 3 };
+
+    char buy_client_id[24];
+    char sell_client_id[24];
+    double price;
+    std::int32_t quantity;
+    std::uint8_t kind;            ///< Kind
+    std::uint8_t reason;          ///< REJECTED: RejectReason
+    std::uint8_t reserved[2];
+
+    static ShmReportMessage from_report(const ExecutionReport& report) {
+        ShmReportMessage message = {};
+        if (report.type == ReportType::TRADE) {
+            const Trade& trade = report.trade;
+            std::strncpy(message.buy_client_id, trade.buy_client_id.c_str(), sizeof(message.buy_client_id) - 1);
+            std::strncpy(message.sell_client_id, trade.sell_client_id.c_str(), sizeof(message.sell_client_id) - 1);
+            message.price = trade.price;
+            message.quantity = trade.quantity;
+            message.kind = TRADE;
+            return message;
+        }
+
+        char* client_id = (report.side == OrderSide::BUY) ? message.buy_client_id : message.sell_client_id;
+        std::strncpy(client_id, report.client_id.c_str(), sizeof(message.buy_client_id) - 1);
+        message.price = report.price;
+        message.quantity = report.leaves_quantity;
+        message.kind = (report.type == ReportType::CANCELED) ? CANCELED : EXPIRED;
+        return message;
+    }
+
+    /// Refusal of a request from the client; its client ID is echoed only if well-formed
+    static ShmReportMessage rejected(const ShmOrderMessage& request, RejectReason reason) {
+        ShmReportMessage message = {};
+        if (std::memchr(request.client_id, '\0', sizeof(request.client_id))) {
+            char* client_id = (request.side == static_cast<std::uint8_t>(OrderSide::SELL))
+                ? message.sell_client_id : message.buy_client_id;
+            std::memcpy(client_id, request.client_id, sizeof(request.client_id));
+        }
+        message.price = request.price;
+        message.quantity = request.quantity;
+        message.kind = REJECTED;
+        message.reason = static_cast<std::uint8_t>(reason);
+        return message;
+    }
+
+    /**
+     * @brief Converts the report to a human-readable string.
+     */
+    std::string to_string() const {
+        if (kind == TRADE) {
+            return Trade(buy_client_id, sell_client_id, price, quantity).to_string();
+        }
+        if (kind == REJECTED) {
+            return "REJECTED: " + ::to_string(static_cast<RejectReason>(reason));
+        }
+
+        const bool buy = buy_client_id[0] != '\0';
+        std::ostringstream oss;
+        oss << (kind == CANCELED ? "CANCELED: " : "EXPIRED: ") << (buy ? "BUY " : "SELL ")
+            << quantity << " @ " << price << " [CLIENT: " << (buy ? buy_client_id : sell_client_id) << "]";
+        return oss.str();
+    }
+};
+
+static_assert(std::is_trivially_copyable<ShmOrderMessage>::value, "shared across processes");
+static_assert(std::is_trivially_copyable<ShmReportMessage>::value, "shared across processes");
+
+/**
+ * @brief Layout of one client's shared-memory region: a ring in each direction.
+ *
+ * The rings are ordinary SpscQueues constructed in place by the server;
+ * their lock-free atomics work across processes that map the same pages.
+ */
+struct ShmRegion {
+    static constexpr std::uint32_t kMagic = 0x314D454F;  // "OEM1"
+    static constexpr std::size_t kRingCapacity = 4096;
+
+    std::uint32_t magic = kMagic;
+    SpscQueue<ShmOrderMessage, kRingCapacity> inbound;    ///< Client → server
+    SpscQueue<ShmReportMessage, kRingCapacity> outbound;  ///< Server → client
+};
+
+/**
+ * @brief A mapped shared-memory channel between the server and one client.
+ *
+ * The server create()s the segment and unlinks it when the channel is
+ * destroyed; the client open()s it by the name returned in the handshake.
+ * POSIX only: on other platforms both factories return nullptr.
+ */
+class ShmChannel {
+public:
+    /// Server side: creates, sizes and initialises a new segment
+    static std::unique_ptr<ShmChannel> create(const std::string& name);
+
+    /// Client side: maps an existing segment created by the server
+    static std::unique_ptr<ShmChannel> open(const std::string& name);
+
+    /// Segment name for a session, unique per server process
+    static std::string name_for(SessionId session_id);
+
+    ~ShmChannel();
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    ShmRegion& region() { return *region_; }
+    const std::string& name() const { return name_; }
+
+private:
+    ShmChannel(std::string name, ShmRegion* region, bool owner)
+        : name_(std::move(name)), region_(region), owner_(owner) {}
+
+    std::string name_;
+    ShmRegion* region_;
+    bool owner_;
+};
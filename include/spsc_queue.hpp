@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A bounded, lock-free single-producer/single-consumer ring buffer.
+ *
+ * Exactly one thread may push and exactly one (other) thread may pop at any
+ * given time. Head and tail live on separate cache lines so the producer and
+ * consumer never contend on the same line. Capacity must be a power of two.
+ */
+template<typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+
+    ~SpscQueue() {
+        while (try_pop()) {}
+    }
+
+    // Non-copyable
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Producer side. Returns false (and leaves `item` untouched) if the queue is full.
+     */
+    bool try_push(T&& item) {
+        return emplace(std::move(item));
+    }
+
+    bool try_push(const T& item) {
+        return emplace(item);
+    }
+
+    /**
+     * @brief Consumer side. Returns std::nullopt if the queue is empty.
+     */
+    std::optional<T> try_pop() {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return std::nullopt;
+
+        T* slot = slot_at(head);
+        std::optional<T> item(std::move(*slot));
+        slot->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    /**
+     * @brief Approximate emptiness check; exact only when called from the consumer.
+     */
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    template<typename U>
+    bool emplace(U&& item) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+
+        new (slot_at(tail)) T(std::forward<U>(item));
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    T* slot_at(std::size_t index) {
+        return std::launder(reinterpret_cast<T*>(&storage_[index & (Capacity - 1)]));
+    }
+
+    static constexpr std::size_t kCacheLine = 64;
+
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};   ///< Next slot to pop (consumer-owned)
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};   ///< Next slot to fill (producer-owned)
+    alignas(kCacheLine) typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_[Capacity];
+};
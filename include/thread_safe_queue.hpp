@@ -1,9 +1,11 @@
 #pragma once
 
 #include <queue>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <optional>
+#include <chrono>
 
 /**
  * @brief A thread-safe queue with blocking and non-blocking pop support.
@@ -11,6 +13,10 @@
  * This queue uses a mutex and condition_variable to ensure safe concurrent
  * access from multiple producer and consumer threads. It supports both
  * copy and move semantics for pushing, and exposes blocking and try-pop methods.
+ *
+ * An atomic item count lets try_pop() return on an empty queue without
+ * taking the mutex, so a busy-polling consumer does not contend with
+ * producers while idle.
  */
 template<typename T>
 class ThreadSafeQueue {
@@ -26,6 +32,7 @@ public:
     void push(const T& item) {
         std::lock_guard<std::mutex> lock(mutex_);
         queue_.push(item);
+        count_.store(queue_.size(), std::memory_order_release);
         cond_var_.notify_one();
     }
 
@@ -33,6 +40,7 @@ public:
     void push(T&& item) {
         std::lock_guard<std::mutex> lock(mutex_);
         queue_.push(std::move(item));
+        count_.store(queue_.size(), std::memory_order_release);
         cond_var_.notify_one();
     }
 
@@ -44,16 +52,33 @@ public:
         cond_var_.wait(lock, [this] { return !queue_.empty(); });
         out = std::move(queue_.front());
         queue_.pop();
+        count_.store(queue_.size(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Blocks for at most `timeout` waiting for an item.
+     * @return true if an item was popped into `out`
+     */
+    template<typename Rep, typename Period>
+    bool wait_for_and_pop(T& out, const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cond_var_.wait_for(lock, timeout, [this] { return !queue_.empty(); })) return false;
+        out = std::move(queue_.front());
+        queue_.pop();
+        count_.store(queue_.size(), std::memory_order_relaxed);
+        return true;
     }
 
     /**
      * @brief Non-blocking pop. Returns std::nullopt if empty.
      */
     std::optional<T> try_pop() {
+        if (count_.load(std::memory_order_acquire) == 0) return std::nullopt;  // Lock-free fast path
         std::lock_guard<std::mutex> lock(mutex_);
         if (queue_.empty()) return std::nullopt;
         T item = std::move(queue_.front());
         queue_.pop();
+        count_.store(queue_.size(), std::memory_order_relaxed);
         return item;
     }
 
@@ -76,5 +101,6 @@ public:
 private:
     mutable std::mutex mutex_;
     std::queue<T> queue_;
+    std::atomic<std::size_t> count_{0};  // Mirrors queue_.size(); written under mutex_
     std::condition_variable cond_var_;
 };
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class TimerWheel;
+
+/**
+ * @brief Intrusive hook for an object that can be scheduled on a TimerWheel.
+ *
+ * Embed by inheritance. A node cancels itself when destroyed, so an owner
+ * that is removed for any other reason (e.g. a full fill) never leaves a
+ * dangling timer behind. Nodes are pinned in memory while scheduled.
+ */
+class TimerNode {
+public:
+    TimerNode() = default;
+    ~TimerNode() { cancel(); }
+
+    TimerNode(const TimerNode&) = delete;
+    TimerNode& operator=(const TimerNode&) = delete;
+
+    /// True while linked into a wheel
+    bool scheduled() const { return wheel_ != nullptr; }
+
+    /// Tick at which this timer fires (valid while scheduled)
+    std::uint64_t expiry_tick() const { return expiry_tick_; }
+
+    /// Removes the timer from its wheel, if any. O(1)
+    inline void cancel();
+
+private:
+    friend class TimerWheel;
+
+    void link_before(TimerNode& head) {
+        prev_ = head.prev_;
+        next_ = &head;
+        head.prev_->next_ = this;
+        head.prev_ = this;
+    }
+
+    void unlink() {
+        prev_->next_ = next_;
+        next_->prev_ = prev_;
+        prev_ = next_ = this;
+    }
+
+    TimerNode* prev_ = this;
+    TimerNode* next_ = this;
+    std::uint64_t expiry_tick_ = 0;
+    TimerWheel* wheel_ = nullptr;
+};
+
+/**
+ * @brief Hierarchical timing wheel with O(1) schedule and cancel.
+ *
+ * Five levels of 64 slots each cover 2^30 ticks (about 12 days at 1 ms per
+ * tick); anything further out parks in the top level and is re-filed when
+ * its slot comes round. Timers in a higher level are cascaded down one level
+ * each time the level below wraps.
+ *
+ * advance() takes an expiry budget so that a large batch of timers due on
+ * the same tick (e.g. end-of-day expiry) can be drained in bounded slices
+ * interleaved with other work.
+ */
+class TimerWheel {
+public:
+    static constexpr unsigned kSlotBits = 6;
+    static constexpr unsigned kSlots = 1u << kSlotBits;
+    static constexpr unsigned kLevels = 5;
+
+    explicit TimerWheel(std::uint64_t start_tick = 0) : current_tick_(start_tick) {}
+
+    ~TimerWheel() {
+        for (auto& level : slots_) {
+            for (auto& head : level) {
+                while (head.next_ != &head) {
+                    TimerNode* node = head.next_;
+                    node->unlink();
+                    node->wheel_ = nullptr;
+                }
+            }
+        }
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief Schedules (or reschedules) `node` to fire at `expiry_tick`.
+     *
+     * A tick at or before the current one fires on the next advance().
+     */
+    void schedule(TimerNode& node, std::uint64_t expiry_tick) {
+        node.cancel();
+        node.expiry_tick_ = expiry_tick;
+        node.wheel_ = this;
+        place(node);
+        ++size_;
+    }
+
+    /**
+     * @brief Moves time forward to `now_tick`, expiring at most `budget` timers.
+     *
+     * Each expired node is unlinked before `on_expire(TimerNode&)` is called,
+     * so the callback may destroy it. If the budget runs out, the wheel stops
+     * on the current tick and the next call resumes from there. An empty
+     * wheel moves straight to `now_tick`.
+     *
+     * @return Number of timers expired
+     */
+    template<typename OnExpire>
+    std::size_t advance(std::uint64_t now_tick, std::size_t budget, OnExpire&& on_expire) {
+        std::size_t expired = 0;
+        if (size_ == 0) {
+            current_tick_ = now_tick;  // Nothing pending: an empty wheel just adopts the new time
+            return expired;
+        }
+
+        while (true) {
+            TimerNode& head = slots_[0][current_tick_ & kSlotMask];
+            while (head.next_ != &head) {
+                if (expired == budget) return expired;
+                TimerNode* node = head.next_;
+                node->unlink();
+                node->wheel_ = nullptr;
+                --size_;
+                ++expired;
+                on_expire(*node);
+            }
+
+            if (current_tick_ >= now_tick) break;
+            if (size_ == 0) {
+                current_tick_ = now_tick;  // Nothing pending: skip idle ticks
+                break;
+            }
+
+            ++current_tick_;
+            cascade();
+        }
+
+        return expired;
+    }
+
+    /**
+     * @brief Visits every scheduled node as `visit(const TimerNode&, level, slot)`.
+     *
+     * Nodes in a slot are visited in the order the wheel fires or cascades
+     * them, so restore()-ing them in visiting order rebuilds the same wheel.
+     */
+    template<typename Visit>
+    void for_each(Visit&& visit) const {
+        for (unsigned level = 0; level < kLevels; ++level) {
+            for (unsigned slot = 0; slot < kSlots; ++slot) {
+                const TimerNode& head = slots_[level][slot];
+                for (const TimerNode* node = head.next_; node != &head; node = node->next_) {
+                    visit(*node, level, slot);
+                }
+            }
+        }
+    }
+
+    /// Moves an empty wheel to `tick` (e.g. before restoring a snapshot)
+    void reset(std::uint64_t tick) { current_tick_ = tick; }
+
+    /// Links `node` at the back of the level and slot for_each() reported it in
+    void restore(TimerNode& node, std::uint64_t expiry_tick, unsigned level, unsigned slot) {
+        node.cancel();
+        node.expiry_tick_ = expiry_tick;
+        node.wheel_ = this;
+        node.link_before(slots_[level % kLevels][slot & kSlotMask]);
+        ++size_;
+    }
+
+    /// Number of scheduled timers
+    std::size_t size() const { return size_; }
+
+    /// Tick the wheel has advanced to
+    std::uint64_t current_tick() const { return current_tick_; }
+
+private:
+    friend class TimerNode;
+
+    static constexpr std::uint64_t kSlotMask = kSlots - 1;
+    static constexpr std::uint64_t kMaxDelta = (std::uint64_t{1} << (kSlotBits * kLevels)) - 1;
+
+    void remove(TimerNode& node) {
+        node.unlink();
+        node.wheel_ = nullptr;
+        --size_;
+    }
+
+    /// Files a node into the level whose span covers its distance from now
+    void place(TimerNode& node) {
+        std::uint64_t expiry = node.expiry_tick_;
+        if (expiry < current_tick_) expiry = current_tick_;
+
+        std::uint64_t delta = expiry - current_tick_;
+        if (delta > kMaxDelta) {
+            delta = kMaxDelta;
+            expiry = current_tick_ + kMaxDelta;
+        }
+
+        unsigned level = 0;
+        while (level + 1 < kLevels && delta >= (std::uint64_t{1} << (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+
+        const std::uint64_t slot = (expiry >> (kSlotBits * level)) & kSlotMask;
+        node.link_before(slots_[level][slot]);
+    }
+
+    /// On a level-0 wrap, re-files the due slot of each level whose boundary was crossed
+    void cascade() {
+        for (unsigned level = 1; level < kLevels; ++level) {
+            const unsigned shift = kSlotBits * level;
+            if ((current_tick_ & ((std::uint64_t{1} << shift) - 1)) != 0) break;
+
+            TimerNode& head = slots_[level][(current_tick_ >> shift) & kSlotMask];
+            TimerNode pending;  // Detach the slot first so re-filing cannot land back in it
+            if (head.next_ != &head) {
+                pending.next_ = head.next_;
+                pending.prev_ = head.prev_;
+                head.next_->prev_ = &pending;
+                head.prev_->next_ = &pending;
+                head.next_ = head.prev_ = &head;
+            }
+            while (pending.next_ != &pending) {
+                TimerNode* node = pending.next_;
+                node->unlink();
+                place(*node);
+            }
+        }
+    }
+
+    TimerNode slots_[kLevels][kSlots];
+    std::uint64_t current_tick_;
+    std::size_t size_ = 0;
+};
+
+inline void TimerNode::cancel() {
+    if (wheel_) wheel_->remove(*this);
+}
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <sstream>
+#include <chrono>
+#include "order.hpp"
 
 /**
  * @brief Represents a completed trade between a buyer and a seller.
@@ -11,10 +13,21 @@ struct Trade {
     std::string sell_client_id;  ///< ID of the selling client
     double price;                ///< Execution price
     int quantity;                ///< Quantity traded
+    SessionId buy_session;       ///< Gateway session of the buyer (kNoSession if unknown)
+    SessionId sell_session;      ///< Gateway session of the seller (kNoSession if unknown)
+    std::string buy_order_id;    ///< Engine ID of the buy order (empty if unknown)
+    std::string sell_order_id;   ///< Engine ID of the sell order (empty if unknown)
+    std::chrono::system_clock::time_point timestamp{};  ///< Engine clock at execution (set on publish)
 
 
-    Trade(const std::string& buy, const std::string& sell, double pr, int qty)
-        : buy_client_id(buy), sell_client_id(sell), price(pr), quantity(qty) {}
+    Trade() : Trade({}, {}, 0.0, 0) {}
+
+    Trade(const std::string& buy, const std::string& sell, double pr, int qty,
+          SessionId buy_sess = kNoSession, SessionId sell_sess = kNoSession,
+          const std::string& buy_order = {}, const std::string& sell_order = {})
+        : buy_client_id(buy), sell_client_id(sell), price(pr), quantity(qty),
+          buy_session(buy_sess), sell_session(sell_sess),
+          buy_order_id(buy_order), sell_order_id(sell_order) {}
 
     /**
      * @brief Converts the trade to a human-readable string.
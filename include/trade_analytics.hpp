@@ -0,0 +1,179 @@
+#pragma once
+
+#include "trade.hpp"
+#include "seqlock.hpp"
+#include "spsc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Open/high/low/close and volume over one time bucket.
+ */
+struct OhlcvBar {
+    std::uint64_t start_ms;   ///< Bucket start (ms since epoch)
+    double open;
+    double high;
+    double low;
+    double close;
+    long long volume;
+    double notional;          ///< Sum of price * quantity
+    std::uint32_t trades;
+
+    double vwap() const { return volume > 0 ? notional / volume : 0.0; }
+};
+
+/**
+ * @brief Session-wide running totals.
+ */
+struct TradeTotals {
+    std::uint64_t trades;
+    std::uint64_t bars;       ///< Bars opened so far (the ring keeps the latest kBarCount)
+    std::uint64_t dropped;    ///< Trades lost because the analytics queue was full
+    long long volume;
+    double notional;
+    double last_price;
+
+    double vwap() const { return volume > 0 ? notional / volume : 0.0; }
+};
+
+/**
+ * @brief Traded volume and notional for one client ID.
+ */
+struct ClientVolume {
+    char client_id[24];       ///< NUL-terminated, truncated to 23 characters
+    long long bought;
+    long long sold;
+    double notional;
+    std::uint32_t trades;
+};
+
+/**
+ * @brief Incremental trade statistics maintained off the matching thread.
+ *
+ * The trade-routing thread hands each trade over as a fixed-size print on a
+ * lock-free ring; a dedicated analytics thread folds it into OHLCV bars,
+ * running VWAP and per-client volume. All state lives in fixed-size tables
+ * allocated up front, so memory is constant however long the session runs:
+ * bars are a ring of the latest kBarCount buckets, and clients beyond
+ * kMaxClients are accounted under a shared overflow entry.
+ *
+ * Every published value sits behind a seqlock, so queries from any thread
+ * are O(1), lock-free, and never delay the analytics thread. The totals and
+ * the current bar share one seqlock, so snapshot() sees both as of the same
+ * trade; closed bars move to the ring when the next bar opens.
+ */
+class TradeAnalytics {
+public:
+    static constexpr std::size_t kBarCount = 1024;
+    static constexpr std::size_t kMaxClients = 4096;
+    static constexpr std::size_t kQueueCapacity = 1 << 14;
+
+    /// Client ID under which trades of clients beyond kMaxClients are counted
+    static constexpr const char* kOverflowClient = "*OTHER*";
+
+    explicit TradeAnalytics(std::chrono::milliseconds bar_interval = std::chrono::seconds(1));
+    ~TradeAnalytics();
+
+    // Non-copyable
+    TradeAnalytics(const TradeAnalytics&) = delete;
+    TradeAnalytics& operator=(const TradeAnalytics&) = delete;
+
+    /// Starts the analytics thread
+    void start();
+
+    /// Processes whatever is still queued, then joins the analytics thread
+    void stop();
+
+    /// Pins the analytics thread to one core. Call before start()
+    void set_cpu_core(int core) { cpu_core_ = core; }
+
+    /**
+     * @brief Single producer thread only. Queues a trade for analysis.
+     *
+     * Never blocks: if the analytics thread has fallen a whole ring behind,
+     * the trade is counted in TradeTotals::dropped instead.
+     */
+    void record(const Trade& trade);
+
+    /// Running totals and session VWAP
+    TradeTotals totals() const;
+
+    /**
+     * @brief Running totals and the current bar, both as of the same trade.
+     *
+     * @return False if no bar has opened yet (`current` is then left untouched)
+     */
+    bool snapshot(TradeTotals& totals, OhlcvBar& current) const;
+
+    /**
+     * @brief The bar `age` buckets back from the most recent one (0 = current).
+     *
+     * Only buckets that saw a trade have a bar.
+     * @return False if no such bar is retained
+     */
+    bool bar(std::size_t age, OhlcvBar& out) const;
+
+    /**
+     * @brief Volume traded by one client.
+     *
+     * @return False if the client has not traded
+     */
+    bool client_volume(const std::string& client_id, ClientVolume& out) const;
+
+    /// Writes totals, the retained bars and per-client volume as CSV sections
+    void write_report(std::ostream& out) const;
+
+    /// Writes the report to a file
+    void write_report_to_file(const std::string& filename) const;
+
+private:
+    static constexpr std::size_t kMaxProbe = 32;
+
+    /// Fixed-size trade as handed to the analytics thread
+    struct TradePrint {
+        std::uint64_t time_ms;
+        double price;
+        std::int32_t quantity;
+        char buy_client_id[24];
+        char sell_client_id[24];
+    };
+
+    /// What one seqlock publishes after each trade
+    struct Summary {
+        TradeTotals totals;
+        OhlcvBar current_bar;  ///< Valid once totals.bars > 0
+    };
+
+    using BarSlot = Seqlock<OhlcvBar>;
+    using ClientSlot = Seqlock<ClientVolume>;
+
+    void run();
+    void apply(const TradePrint& print);
+    void add_client_volume(const char* client_id, long long bought, long long sold, double notional);
+
+    /// Open-addressed slot for `client_id`, claiming an empty one (analytics thread only)
+    ClientSlot* claim_client(const char* client_id);
+
+    /// First slot probed for `client_id`
+    static std::size_t home_slot(const char* client_id);
+
+    const std::uint64_t bar_interval_ms_;
+
+    SpscQueue<TradePrint, kQueueCapacity> queue_;
+    std::atomic<std::uint64_t> dropped_{0};
+
+    Seqlock<Summary> summary_;
+    std::unique_ptr<BarSlot[]> bars_;  // Closed bars: bar n sits in slot n % kBarCount
+    std::unique_ptr<ClientSlot[]> clients_;
+    std::size_t client_count_ = 0;   // Analytics thread only
+
+    std::atomic<bool> running_{false};
+    int cpu_core_ = -1;
+    std::thread thread_;
+};
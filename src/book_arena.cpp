@@ -0,0 +1,109 @@
+#include "book_arena.hpp"
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::size_t round_up(std::size_t value, std::size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+BookArena::~BookArena() {
+    for (const Region& region : regions_) {
+#ifdef _WIN32
+        ::operator delete(region.base);
+#else
+        munmap(region.base, region.bytes);
+#endif
+    }
+}
+
+bool BookArena::reserve(std::size_t bytes, bool hugepages, bool lock) {
+    hugepages_ = hugepages;
+    lock_ = lock;
+    reserved_ = map_region(bytes);
+    return reserved_;
+}
+
+void* BookArena::allocate(std::size_t bytes, std::size_t alignment) {
+    if (!reserved_ || bytes > kMaxBlock || alignment > kGranule) {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    const std::size_t size = round_up(bytes == 0 ? 1 : bytes, kGranule);
+    FreeBlock*& free_list = free_lists_[size / kGranule - 1];
+    if (free_list) {
+        FreeBlock* block = free_list;
+        free_list = block->next;
+        return block;
+    }
+
+    if (static_cast<std::size_t>(limit_ - cursor_) < size && !map_region(kRegionBytes)) {
+        throw std::bad_alloc();
+    }
+    void* block = cursor_;
+    cursor_ += size;
+    return block;
+}
+
+void BookArena::deallocate(void* block, std::size_t bytes, std::size_t alignment) noexcept {
+    if (!reserved_ || bytes > kMaxBlock || alignment > kGranule) {
+        ::operator delete(block, std::align_val_t(alignment));
+        return;
+    }
+
+    const std::size_t size = round_up(bytes == 0 ? 1 : bytes, kGranule);
+    FreeBlock*& free_list = free_lists_[size / kGranule - 1];
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = free_list;
+    free_list = freed;
+}
+
+bool BookArena::map_region(std::size_t bytes) {
+    bytes = round_up(bytes == 0 ? kRegionBytes : bytes, kRegionBytes);
+
+#ifdef _WIN32
+    void* base = ::operator new(bytes, std::nothrow);
+    if (!base) return false;
+#else
+    void* base = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (hugepages_) {
+        // Explicit huge pages need a reserved pool (vm.nr_hugepages); fall back quietly
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) huge_backed_ = true;
+    }
+#endif
+    if (base == MAP_FAILED) {
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) return false;
+#ifdef MADV_HUGEPAGE
+        if (hugepages_) madvise(base, bytes, MADV_HUGEPAGE);  // Transparent huge pages, if enabled
+#endif
+    }
+
+    if (lock_ && !lock_failed_ && mlock(base, bytes) != 0) {
+        std::cerr << "[BookArena] mlock failed (check RLIMIT_MEMLOCK); book memory is not locked.\n";
+        lock_failed_ = true;
+    }
+#endif
+
+    // Pre-fault every page now rather than on the matching path
+    const std::size_t page = 4096;
+    for (std::size_t offset = 0; offset < bytes; offset += page) {
+        static_cast<volatile char*>(base)[offset] = 0;
+    }
+
+    regions_.push_back({base, bytes});
+    mapped_bytes_ += bytes;
+    cursor_ = static_cast<char*>(base);
+    limit_ = cursor_ + bytes;
+    return true;
+}
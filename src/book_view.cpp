@@ -0,0 +1,122 @@
+#include "book_view.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+template<typename Levels>
+std::uint32_t copy_depth(const Levels& levels, DepthLevel (&out)[BookSnapshot::kDepth]) {
+    std::uint32_t count = 0;
+    for (auto it = levels.begin(); it != levels.end() && count < BookSnapshot::kDepth; ++it, ++count) {
+        out[count].price = it->first;
+        out[count].quantity = it->second.quantity;
+        out[count].orders = static_cast<std::uint32_t>(it->second.orders.size());
+    }
+    return count;
+}
+
+} // namespace
+
+BookView::BookView() : statuses_(new StatusSlot[kStatusSlots]) {}
+
+void BookView::publish_book(const OrderBook& book, std::uint64_t sequence, double last_trade_price,
+                            bool in_auction) {
+    book_.update([&](BookSnapshot& snapshot) {
+        snapshot.sequence = sequence;
+        snapshot.last_trade_price = last_trade_price;
+        snapshot.in_auction = in_auction;
+        snapshot.bid_levels = copy_depth(book.buy_orders(), snapshot.bids);
+        snapshot.ask_levels = copy_depth(book.sell_orders(), snapshot.asks);
+    });
+}
+
+void BookView::order_accepted(const Order& order) {
+    OrderStatusRecord record{};
+    copy_id(record.order_id, order.id());
+    record.price = order.price();
+    record.quantity = order.quantity();
+    record.filled_quantity = 0;
+    record.status = OrderStatus::NEW;
+    record.side = order.side();
+
+    // Reuse the order's own slot if its ID is already tracked, else the first free or closed one
+    const std::size_t home = home_slot(order.id());
+    StatusSlot* target = nullptr;
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+        StatusSlot& slot = statuses_[(home + probe) & (kStatusSlots - 1)];
+        const OrderStatusRecord& current = slot.writer_value();
+        if (current.status != OrderStatus::UNKNOWN
+            && std::memcmp(current.order_id, record.order_id, sizeof(record.order_id)) == 0) {
+            target = &slot;
+            break;
+        }
+        if (!target && reusable(current)) target = &slot;
+        if (current.status == OrderStatus::UNKNOWN) break;  // End of the chain
+    }
+    if (target) target->store(record);  // Else every slot in reach is working: untracked
+}
+
+void BookView::order_filled(const std::string& order_id, int quantity) {
+    StatusSlot* slot = find_slot(order_id);
+    if (!slot) return;  // Untracked
+
+    slot->update([quantity](OrderStatusRecord& record) {
+        record.filled_quantity += quantity;
+        record.status = record.filled_quantity >= record.quantity ? OrderStatus::FILLED
+                                                                  : OrderStatus::PARTIALLY_FILLED;
+    });
+}
+
+void BookView::order_closed(const std::string& order_id, OrderStatus status) {
+    StatusSlot* slot = find_slot(order_id);
+    if (!slot) return;
+
+    slot->update([status](OrderStatusRecord& record) { record.status = status; });
+}
+
+void BookView::reset() {
+    for (std::size_t i = 0; i < kStatusSlots; ++i) {
+        statuses_[i].store(OrderStatusRecord{});
+    }
+}
+
+bool BookView::order_status(const std::string& order_id, OrderStatusRecord& out) const {
+    char key[24];
+    copy_id(key, order_id);
+
+    const std::size_t home = home_slot(order_id);
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+        out = statuses_[(home + probe) & (kStatusSlots - 1)].load();
+        if (out.status == OrderStatus::UNKNOWN) return false;  // End of the chain
+        if (std::memcmp(out.order_id, key, sizeof(key)) == 0) return true;
+    }
+    return false;
+}
+
+std::size_t BookView::home_slot(const std::string& order_id) {
+    return std::hash<std::string>{}(order_id) & (kStatusSlots - 1);
+}
+
+BookView::StatusSlot* BookView::find_slot(const std::string& order_id) const {
+    char key[24];
+    copy_id(key, order_id);
+
+    const std::size_t home = home_slot(order_id);
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+        StatusSlot& slot = statuses_[(home + probe) & (kStatusSlots - 1)];
+        const OrderStatusRecord& record = slot.writer_value();
+        if (record.status == OrderStatus::UNKNOWN) return nullptr;
+        if (std::memcmp(record.order_id, key, sizeof(key)) == 0) return &slot;
+    }
+    return nullptr;
+}
+
+void BookView::copy_id(char (&dest)[24], const std::string& order_id) {
+    std::memset(dest, 0, sizeof(dest));
+    std::memcpy(dest, order_id.data(), std::min(order_id.size(), sizeof(dest) - 1));
+}
+
+bool BookView::reusable(const OrderStatusRecord& record) {
+    return record.status != OrderStatus::NEW && record.status != OrderStatus::PARTIALLY_FILLED;
+}
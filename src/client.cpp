@@ -1,9 +1,14 @@
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <cstring>
+#include <cerrno>
 
 #include "../include/platform.hpp"
+#include "../include/shm_channel.hpp"
 
 
 std::atomic<bool> running{true};
@@ -34,7 +39,112 @@ void receive_messages(SOCKET sock) {
     }
 }
 
-int main() {
+/**
+ * @brief Polls the shared-memory report ring and prints reports from the server.
+ *
+ * The TCP socket is only checked now and then, to notice the server going away.
+ *
+ * @param region Mapped shared-memory channel
+ * @param sock Connected socket to the server
+ */
+void receive_shm_reports(ShmRegion& region, SOCKET sock) {
+    constexpr std::size_t kLivenessPolls = 1 << 16;
+    std::size_t idle_polls = 0;
+
+    while (running) {
+        auto report = region.outbound.try_pop();
+        if (report) {
+            idle_polls = 0;
+            std::cout << "\n[Server]: " << report->to_string() << "\n> ";
+            std::cout.flush();
+            continue;
+        }
+
+        if (++idle_polls % kLivenessPolls == 0) {
+#ifndef _WIN32
+            char probe;
+            const int bytes = recv(sock, &probe, 1, MSG_DONTWAIT);
+            if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                std::cout << "\n[Info] Server closed the connection.\n";
+                running = false;
+                break;
+            }
+#endif
+        }
+        cpu_relax();
+    }
+}
+
+/**
+ * @brief Asks the server to move this session onto shared memory.
+ *
+ * @return The mapped channel, or nullptr if the server declined
+ */
+std::unique_ptr<ShmChannel> negotiate_shm(SOCKET sock) {
+    const std::string request = "SHM\n";
+    if (send(sock, request.c_str(), static_cast<int>(request.length()), 0) == SOCKET_ERROR) return nullptr;
+
+    // The reply is a single line: "SHM <name>" or "ERROR <reason>"
+    std::string reply;
+    char c;
+    while (recv(sock, &c, 1, 0) == 1 && c != '\n') {
+        reply += c;
+    }
+
+    if (reply.rfind("SHM ", 0) != 0) {
+        std::cerr << "[Error] Server refused shared memory: " << reply << "\n";
+        return nullptr;
+    }
+    return ShmChannel::open(reply.substr(4));
+}
+
+/**
+ * @brief Parses "CLIENT_ID,PRICE,QUANTITY,SIDE[,TIF[,SECONDS_TO_EXPIRY]]" into a binary order,
+ *        or "CANCEL_ALL[,SIDE[,PRICE]]" into a mass cancel.
+ */
+bool parse_shm_order(const std::string& line, ShmOrderMessage& message) {
+    try {
+        CancelFilter filter;
+        if (parse_cancel_all(line, filter)) {
+            message = {};
+            message.kind = ShmOrderMessage::CANCEL_ALL;
+            message.side_filter = filter.side.has_value();
+            message.side = static_cast<std::uint8_t>(filter.side.value_or(OrderSide::BUY));
+            message.price = filter.price;
+            return true;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    std::istringstream ss(line);
+    std::string client_id, price_str, qty_str, side_str, tif_str, expiry_str;
+    if (!(std::getline(ss, client_id, ',') && std::getline(ss, price_str, ',') &&
+          std::getline(ss, qty_str, ',') && std::getline(ss, side_str, ','))) {
+        return false;
+    }
+    std::getline(ss, tif_str, ',');
+    std::getline(ss, expiry_str);
+
+    try {
+        message = {};
+        if (client_id.size() > kMaxClientIdLength) return false;  // Would not fit the fixed field
+        std::strncpy(message.client_id, client_id.c_str(), sizeof(message.client_id) - 1);
+        message.price = std::stod(price_str);
+        message.quantity = std::stoi(qty_str);
+        message.side = static_cast<std::uint8_t>(parse_order_side(side_str));
+        message.time_in_force = static_cast<std::uint8_t>(parse_time_in_force(tif_str));
+        message.expiry_seconds = expiry_str.empty() ? 0 : std::stoll(expiry_str);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // --shm: co-located mode, orders and reports over shared memory
+    const bool use_shm = (argc > 1 && std::string(argv[1]) == "--shm");
+
     SOCKET sock = INVALID_SOCKET;
     const char* server_ip = "127.0.0.1";
     const int port = 54000;
@@ -75,11 +185,26 @@ int main() {
 
     std::cout << "Connected to " << server_ip << ":" << port << "\n";
     std::cout << "Enter orders in format: CLIENT_ID,PRICE,QUANTITY,SIDE\n";
+    std::cout << "Optional time in force: ...,SIDE,DAY or ...,SIDE,GTD,SECONDS_TO_EXPIRY (default GTC)\n";
     std::cout << "Example: B1,101.5,10,BUY\n";
+    std::cout << "Queries: BOOK (top of book), STATUS,ORDER_ID (order status; IDs are returned in ACK lines)\n";
+    std::cout << "Mass cancel: CANCEL_ALL[,SIDE[,PRICE]] (resting orders are also canceled on disconnect)\n";
     std::cout << "Type 'exit' to quit.\n\n";
 
+    std::unique_ptr<ShmChannel> shm;
+    if (use_shm) {
+        shm = negotiate_shm(sock);
+        if (!shm) {
+            closesocket(sock);
+            return 1;
+        }
+        std::cout << "Using shared-memory channel " << shm->name() << "\n";
+    }
+
     // Start receive thread
-    std::thread recv_thread(receive_messages, sock);
+    std::thread recv_thread = shm
+        ? std::thread(receive_shm_reports, std::ref(shm->region()), sock)
+        : std::thread(receive_messages, sock);
 
     std::string line;
     while (running) {
@@ -91,6 +216,18 @@ int main() {
             break;
         }
 
+        if (shm) {
+            ShmOrderMessage message;
+            if (!parse_shm_order(line, message)) {
+                std::cerr << "[Error] Invalid order format.\n";
+                continue;
+            }
+            while (running && !shm->region().inbound.try_push(message)) {
+                cpu_relax();  // Server is behind; the ring is bounded
+            }
+            continue;
+        }
+
         line += "\n";
         int sent = send(sock, line.c_str(), static_cast<int>(line.length()), 0);
         if (sent == SOCKET_ERROR) {
@@ -1,46 +1,236 @@
 #include "../include/matching_engine.hpp"
 #include "../include/order_server.hpp"
+#include "../include/replication.hpp"
 #include "../include/book_printer.hpp"
+#include "../include/trade_analytics.hpp"
+#include "../include/runtime_profile.hpp"
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <thread>
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Optional roles:
+    //   --replicate <host:port | unix:/path>   primary, streaming its input to standbys
+    //   --standby   <host:port | unix:/path>   hot standby following that primary
+    // Runtime profile (see RuntimeProfile::parse_option):
+    //   --profile low-latency|power-saving, --cores E[,G[,P[,A]]], --book-mb N,
+    //   --hugepages on|off, --mlock on|off, --jitter-ms N
+    std::string replicate_endpoint;
+    std::string standby_endpoint;
+    RuntimeProfile profile;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        try {
+            if (flag == "--replicate") replicate_endpoint = argv[i + 1];
+            else if (flag == "--standby") standby_endpoint = argv[i + 1];
+            else if (!profile.parse_option(flag, argv[i + 1])) std::cerr << "Ignoring unknown option: " << flag << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid value for " << flag << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    std::cout << profile.describe() << "\n";
+
     // Thread-safe queues
-    ThreadSafeQueue<Order> order_input_queue;
-    ThreadSafeQueue<Trade> trade_output_queue;
+    ThreadSafeQueue<EngineEvent> order_input_queue;
+    ThreadSafeQueue<ExecutionReport> report_queue;
+
+    // 1. Start the matching engine (and its replication link, if any)
+    MatchingEngine engine(order_input_queue, report_queue);
+
+    if (profile.low_latency()) {
+        BookArena& memory = engine.book().memory();
+        if (memory.reserve(profile.book_memory_mb << 20, profile.hugepages, profile.lock_memory)) {
+            std::cout << "Book memory: " << (memory.mapped_bytes() >> 20) << " MB pre-faulted"
+                      << (memory.huge_pages() ? ", huge pages" : ", regular pages")
+                      << (memory.locked() ? ", locked" : ", not locked") << "\n";
+        } else {
+            std::cerr << "Could not reserve book memory; allocating on demand.\n";
+        }
+        engine.set_busy_poll(true);
+
+        if (profile.jitter_probe.count() > 0) {
+            const JitterReport jitter = measure_jitter(profile.engine_core, profile.jitter_probe);
+            std::cout << "Jitter probe (engine core): " << jitter.to_string() << "\n";
+        }
+    }
+
+    std::unique_ptr<ReplicationPublisher> replication;
+    if (!replicate_endpoint.empty()) {
+        replication = std::make_unique<ReplicationPublisher>(replicate_endpoint);
+        // Its streaming thread owns the core; its accept thread only ever blocks in accept()
+        replication->set_cpu_core(profile.publisher_core);
+        if (!replication->start()) return 1;
+        engine.set_replication(replication.get());
+    }
+
+    std::unique_ptr<ReplicaReceiver> replica;
+    if (!standby_endpoint.empty()) {
+        replica = std::make_unique<ReplicaReceiver>(standby_endpoint, order_input_queue);
+        // A standby runs no server until PROMOTE, which stops the receiver first: never both at once
+        replica->set_cpu_core(profile.gateway_core);
+        engine.set_replica(true);
+        if (!replica->start()) return 1;
+    }
+
+    std::thread engine_thread([&engine, core = profile.engine_core] {
+        pin_current_thread_or_warn(core, "engine");
+        engine.run();
+    });
+
+    // Trade analytics run on their own thread, fed by the server's report router
+    auto analytics = std::make_unique<TradeAnalytics>();
+    analytics->set_cpu_core(profile.analytics_core);
+    analytics->start();
+
+    // 2. Start the TCP order server (a standby only does so once promoted)
+    std::unique_ptr<OrderServer> server;
+    auto start_server = [&](SessionId first_session_id) {
+        server = std::make_unique<OrderServer>(order_input_queue, report_queue, 54000, first_session_id);
+        server->set_book_view(&engine.view());
+        server->set_trade_analytics(analytics.get());
+        server->set_cpu_core(profile.gateway_core);
+        server->set_busy_poll(profile.low_latency());
+        server->start();
+        std::cout << "Order Matching Engine and TCP server started.\n";
+        std::cout << "Clients can now connect and submit orders.\n";
+    };
+
+    if (replica) {
+        std::cout << "Standby following primary at " << standby_endpoint << ".\n";
+    } else {
+        start_server(1);
+    }
 
-    // 1. Start the matching engine
-    MatchingEngine engine(order_input_queue, trade_output_queue);
-    std::thread engine_thread(&MatchingEngine::run, &engine);
+    std::cout << "Admin commands: AUCTION (start call auction), UNCROSS [reference_price], BOOK, STATUS <order_id>,\n"
+              << "                CANCEL <session> [SIDE [PRICE]], STATS [client_id], LAG, PROMOTE\n";
+    std::cout << "Press Enter on an empty line to stop the system...\n";
 
-    // 2. Start the TCP order server
-    OrderServer server(order_input_queue, trade_output_queue, 54000);
-    server.start();
+    bool following = static_cast<bool>(replica);
+    std::string command;
+    while (std::getline(std::cin, command) && !command.empty()) {
+        std::istringstream iss(command);
+        std::string verb;
+        iss >> verb;
 
-    std::cout << "Order Matching Engine and TCP server started.\n";
-    std::cout << "Clients can now connect and submit orders.\n";
-    std::cout << "Press Enter to stop the system...\n";
-    std::cin.get();
+        if (verb == "BOOK") {
+            // Read while the engine runs: served from its published view, never the live book
+            BookPrinter::print(engine.view().snapshot());
+        } else if (verb == "STATUS") {
+            std::string order_id;
+            iss >> order_id;
+            OrderStatusRecord record;
+            if (engine.view().order_status(order_id, record)) {
+                std::cout << order_id << ": " << to_string(record.status) << ", " << to_string(record.side)
+                          << " " << record.quantity << " @ " << record.price
+                          << ", filled " << record.filled_quantity << ", leaves " << record.leaves_quantity() << "\n";
+            } else {
+                std::cout << order_id << ": unknown\n";
+            }
+        } else if (verb == "STATS") {
+            std::string client_id;
+            iss >> client_id;
+            if (!client_id.empty()) {
+                ClientVolume client;
+                if (analytics->client_volume(client_id, client)) {
+                    std::cout << client_id << ": bought " << client.bought << ", sold " << client.sold
+                              << ", notional " << client.notional << " in " << client.trades << " trades\n";
+                } else {
+                    std::cout << client_id << ": no trades\n";
+                }
+                continue;
+            }
+            // One read, so the totals and the current bar agree
+            TradeTotals totals;
+            OhlcvBar bar;
+            const bool has_bar = analytics->snapshot(totals, bar);
+            std::cout << totals.trades << " trades, volume " << totals.volume << ", VWAP " << totals.vwap()
+                      << ", last " << totals.last_price << "\n";
+            if (has_bar) {
+                std::cout << "Current bar @" << bar.start_ms << ": O " << bar.open << " H " << bar.high
+                          << " L " << bar.low << " C " << bar.close << " V " << bar.volume << "\n";
+            }
+        } else if (verb == "LAG") {
+            if (replica) {
+                std::cout << "Received " << replica->received_sequence()
+                          << ", applied " << engine.applied_sequence()
+                          << ", last transit " << replica->last_lag_us() << " us"
+                          << (replica->connected() ? "" : " (primary disconnected, reconnecting)")
+                          << (replica->consistent() ? "" : " (restoring snapshot)") << "\n";
+            }
+            if (replication) {
+                std::cout << "Published " << replication->published_sequence()
+                          << ", sent " << replication->sent_sequence()
+                          << ", acknowledged " << replication->acked_sequence()
+                          << " by " << replication->standby_count() << " standby(s)\n";
+            }
+        } else if (verb == "PROMOTE") {
+            if (!following) {
+                std::cout << "Already primary.\n";
+                continue;
+            }
+            // Stop following first so every replicated input is queued ahead of PROMOTE
+            replica->stop();
+            if (!replica->consistent()) {
+                // Cut off mid-snapshot: the book is partial, so keep following until a snapshot completes
+                std::cout << "Standby is restoring a snapshot; not promoting.\n";
+                if (!replica->start()) std::cout << "Primary unreachable; the standby cannot be promoted.\n";
+                continue;
+            }
+            order_input_queue.push(EngineEvent::control(EngineEventType::PROMOTE));
+            following = false;
+            // Never reuse an ID or session handle the old primary already gave a client
+            reserve_order_ids(replica->highest_order_number());
+            start_server(replica->highest_session() + 1);
+        } else if (following) {
+            std::cout << "Standby: not accepting input until promoted.\n";
+        } else if (verb == "AUCTION") {
+            order_input_queue.push(EngineEvent::control(EngineEventType::AUCTION_START));
+        } else if (verb == "CANCEL") {
+            SessionId session = kNoSession;
+            std::string side;
+            CancelFilter filter;
+            iss >> session >> side >> filter.price;
+            try {
+                if (!side.empty()) filter.side = parse_order_side(side);
+            } catch (const std::exception& e) {
+                std::cout << e.what() << "\n";
+                continue;
+            }
+            order_input_queue.push(EngineEvent::cancel_client(session, filter));
+        } else if (verb == "UNCROSS") {
+            double reference_price = 0.0;
+            iss >> reference_price;
+            order_input_queue.push(EngineEvent::control(EngineEventType::AUCTION_UNCROSS, reference_price));
+        } else {
+            std::cout << "Unknown command: " << command << "\n";
+        }
+    }
 
     // 3. Shutdown sequence
     std::cout << "Shutting down...\n";
 
-    
+    if (replica) replica->stop();
 
     // Send shutdown order to unblock engine  
-    order_input_queue.push(Order("__SHUTDOWN__", 0.0, 0, OrderSide::BUY));
+    order_input_queue.push(EngineEvent::control(EngineEventType::SHUTDOWN));
     std::cout << "Shutting down engine loop\n";
     engine.stop();  // Stop matching engine loop
     std::cout << "Shutting down client handling threads\n";
-    server.stop();  // Stop client handling threads
+    if (server) server->stop();  // Stop client handling threads
     std::cout << "Waiting for engine_thread to join\n";
     engine_thread.join();
+    if (replication) replication->stop();  // Flush what the engine queued
+    analytics->stop();  // Drains what the server routed
 
     // 4. Optionally print order book
     BookPrinter::print(engine.book());
 
     // 5. Save trade log to CSV
-    server.write_trade_log_to_file("trade_log.csv");
+    if (server) server->write_trade_log_to_file("trade_log.csv");
+    analytics->write_report_to_file("trade_analytics.csv");
 
     std::cout << "All done. Goodbye.\n   ";
     return 0;
@@ -1,35 +1,338 @@
 #include "matching_engine.hpp"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+// Orders expired per slice before the engine looks at its queue again
+constexpr std::size_t kExpiryBatch = 256;
+
+// Longest the engine sleeps on an empty queue before re-checking expiries
+constexpr auto kTimerResolution = std::chrono::milliseconds(10);
+
+constexpr std::uint64_t kTradingDayMs = 24ull * 60 * 60 * 1000;
+
+MatchingEngine::MatchingEngine(EventQueue& in, ReportQueue& out)
+    : in_queue_(in),
+      report_queue_(out),
+      expiry_wheel_(to_tick(current_timestamp())),
+      now_(to_tick(current_timestamp())) {
+    day_close_ = (now_ / kTradingDayMs + 1) * kTradingDayMs;
+}
 
 void MatchingEngine::run() {
     while (running_) {
-        Order order;
-        in_queue_.wait_and_pop(order);  // Blocks until an order arrives
+        if (replica_) {
+            run_replica_step();
+        } else {
+            run_primary_step();
+        }
+    }
+}
+
+void MatchingEngine::run_primary_step() {
+    advance_clock(std::max(now_, to_tick(current_timestamp())));
+
+    EngineEvent event;
+    const bool backlog = expire_orders() == kExpiryBatch;
+    if (backlog || busy_poll_) {
+        // Expiry backlog or busy polling: take at most one event per pass, never block
+        auto next = in_queue_.try_pop();
+        if (!next) {
+            if (!backlog) cpu_relax();
+            return;
+        }
+        event = std::move(*next);
+    } else if (!in_queue_.wait_for_and_pop(event, kTimerResolution)) {
+        return;
+    }
+
+    if (event.type == EngineEventType::SHUTDOWN) {
+        running_ = false;  // Special shutdown signal
+        return;
+    }
+    if (event.type == EngineEventType::PROMOTE || event.type == EngineEventType::EXPIRE_TIMERS ||
+        event.type == EngineEventType::SNAPSHOT || event.type == EngineEventType::RESTORE_ORDER ||
+        event.type == EngineEventType::TAKE_SNAPSHOT) {
+        return;  // Only meaningful on a standby
+    }
+
+    submit(event);
+}
 
-        if (order.id() == "__SHUTDOWN__") {
-            break;  // Special shutdown signal
+void MatchingEngine::submit(EngineEvent& event) {
+    event.sequence = ++sequence_;
+    event.tick = now_;
+    if (event.type == EngineEventType::NEW_ORDER && event.order.time_in_force() == TimeInForce::DAY) {
+        event.order.set_time_in_force(TimeInForce::DAY,
+                                      std::chrono::system_clock::time_point(std::chrono::milliseconds(day_close_)));
+    }
+    if (replication_) replication_->publish(event);  // Before apply() moves the order out
+
+    apply(event);
+    publish_view();
+}
+
+void MatchingEngine::run_replica_step() {
+    EngineEvent event;
+    if (busy_poll_) {
+        auto next = in_queue_.try_pop();
+        if (!next) {
+            cpu_relax();
+            return;
         }
+        event = std::move(*next);
+    } else {
+        in_queue_.wait_and_pop(event);
+    }
 
-        // Match the incoming order against the order book
-        auto matched_orders = book_.match_order(order);
-
-        // For each match, publish a Trade
-        for (Order& top : matched_orders) {
-            Trade trade(
-                (order.side() == OrderSide::BUY) ? order.client_id() : top.client_id(),
-                (order.side() == OrderSide::SELL) ? order.client_id() : top.client_id(),
-                top.price(),
-                top.quantity()
-            );
-            trade_queue_.push(std::move(trade));
+    switch (event.type) {
+        case EngineEventType::SHUTDOWN:
+            running_ = false;
+            return;
+        case EngineEventType::PROMOTE:
+            replica_ = false;
+            std::cout << "[Replica] Promoted to primary at sequence " << sequence_ << "\n";
+            cancel_inherited_sessions();
+            return;
+        case EngineEventType::SNAPSHOT:
+        case EngineEventType::RESTORE_ORDER:
+            restore(event);
+            return;
+        case EngineEventType::TAKE_SNAPSHOT:
+            if (replication_) publish_snapshot();
+            return;
+        default:
+            break;
+    }
+
+    sequence_ = event.sequence;
+    advance_clock(event.tick);
+    if (event.type == EngineEventType::NEW_ORDER && event.order.time_in_force() == TimeInForce::DAY) {
+        day_close_ = to_tick(event.order.expire_time());  // The primary's close, which a snapshot carries on
+    }
+
+    if (event.type == EngineEventType::EXPIRE_TIMERS) {
+        expire_orders();
+    } else {
+        // The primary's wheel had caught up to this tick (or stopped on a
+        // backlog it recorded); step ours the same way without expiring.
+        expiry_wheel_.advance(now_, 0, [](TimerNode&) {});
+        apply(event);
+    }
+    publish_view();
+}
+
+void MatchingEngine::publish_snapshot() {
+    // The wheel's layout decides which of several same-tick expiries fire first
+    std::unordered_map<const TimerNode*, TimerPosition> timers;
+    timers.reserve(expiry_wheel_.size());
+    std::uint32_t rank = 0;
+    expiry_wheel_.for_each([&](const TimerNode& node, unsigned level, unsigned slot) {
+        timers.emplace(&node, TimerPosition{rank++, static_cast<std::uint8_t>(level),
+                                            static_cast<std::uint8_t>(slot)});
+    });
+
+    std::uint32_t orders = 0;
+    for (const auto& [price, level] : book_.buy_orders()) orders += static_cast<std::uint32_t>(level.orders.size());
+    for (const auto& [price, level] : book_.sell_orders()) orders += static_cast<std::uint32_t>(level.orders.size());
+
+    EngineEvent header = EngineEvent::control(EngineEventType::SNAPSHOT);
+    header.sequence = sequence_;
+    header.tick = now_;
+    header.snapshot.day_close = day_close_;
+    header.snapshot.timer_tick = expiry_wheel_.current_tick();
+    header.snapshot.order_number = order_id_counter().load();  // Covers orders that have already left the book
+    header.snapshot.last_trade_price = last_trade_price_;
+    header.snapshot.in_auction = in_auction_;
+    header.snapshot.orders = orders;
+    replication_->publish_snapshot(header);
+
+    // Each side best price first, each level in time priority: re-adding in this order rebuilds it
+    auto restore_side = [&](const auto& levels) {
+        for (const auto& [price, level] : levels) {
+            for (const RestingOrder& order : level) {
+                auto timer = timers.find(&order);
+                replication_->publish_restore(order, sequence_,
+                                              timer != timers.end() ? timer->second : TimerPosition{});
+            }
         }
+    };
+    restore_side(book_.buy_orders());
+    restore_side(book_.sell_orders());
+}
 
-        // Add remaining unmatched portion to the book
-        if (order.quantity() > 0) {
-            book_.add_order(order);
+void MatchingEngine::restore(EngineEvent& event) {
+    if (event.type == EngineEventType::SNAPSHOT) {
+        restored_timers_.clear();
+        book_.clear();
+        view_.reset();
+
+        const SnapshotState& state = event.snapshot;
+        sequence_ = event.sequence;
+        day_close_ = state.day_close;
+        advance_clock(event.tick);
+        expiry_wheel_.reset(state.timer_tick);
+        last_trade_price_ = state.last_trade_price;
+        in_auction_ = state.in_auction;
+        restoring_ = state.orders;
+    } else {
+        if (restoring_ == 0) return;  // Not part of a snapshot
+
+        view_.order_accepted(event.order);
+        const bool timed = event.order.time_in_force() != TimeInForce::GTC;
+        RestingOrder& order = book_.add_order(std::move(event.order));
+        if (timed) restored_timers_.emplace_back(event.timer, &order);
+        --restoring_;
+    }
+
+    if (restoring_ == 0) {
+        // Re-file each expiry exactly where the primary's wheel held it
+        std::sort(restored_timers_.begin(), restored_timers_.end(),
+                  [](const auto& a, const auto& b) { return a.first.rank < b.first.rank; });
+        for (auto& [timer, order] : restored_timers_) {
+            expiry_wheel_.restore(*order, to_tick(order->expire_time()), timer.level, timer.slot);
         }
+        restored_timers_.clear();
+        publish_view();
+    }
+}
+
+void MatchingEngine::apply(EngineEvent& event) {
+    switch (event.type) {
+        case EngineEventType::NEW_ORDER:
+            process_order(event.order);
+            break;
+        case EngineEventType::AUCTION_START:
+            in_auction_ = true;
+            break;
+        case EngineEventType::AUCTION_UNCROSS:
+            uncross_auction(event.reference_price);
+            break;
+        case EngineEventType::CANCEL_CLIENT:
+            cancel_client_orders(event.session, event.cancel_filter);
+            break;
+        default:
+            break;
+    }
+}
+
+void MatchingEngine::process_order(Order& order) {
+    view_.order_accepted(order);
+    if (order.time_in_force() != TimeInForce::GTC && to_tick(order.expire_time()) <= now_) {
+        view_.order_closed(order.id(), OrderStatus::EXPIRED);
+        report_closed(ReportType::EXPIRED, order);
+        return;  // Already expired on arrival
+    }
+
+    if (in_auction_) {
+        schedule_expiry(book_.add_order(std::move(order)));
+        return;
+    }
+
+    // Match the incoming order against the order book and publish the fills
+    auto trades = book_.match_order(order);
+    publish(trades);
+
+    // Add remaining unmatched portion to the book
+    if (order.quantity() > 0) {
+        schedule_expiry(book_.add_order(std::move(order)));
+    }
+}
+
+void MatchingEngine::schedule_expiry(RestingOrder& order) {
+    if (order.time_in_force() != TimeInForce::GTC) {
+        expiry_wheel_.schedule(order, to_tick(order.expire_time()));
+    }
+}
+
+void MatchingEngine::advance_clock(std::uint64_t tick) {
+    now_ = tick;
+    while (now_ >= day_close_) day_close_ += kTradingDayMs;
+}
+
+std::size_t MatchingEngine::expire_orders() {
+    const std::size_t expired = expiry_wheel_.advance(now_, kExpiryBatch, [this](TimerNode& node) {
+        RestingOrder& order = static_cast<RestingOrder&>(node);
+        view_.order_closed(order.id(), OrderStatus::EXPIRED);
+        report_closed(ReportType::EXPIRED, order);
+        book_.remove_order(order);
+    });
+
+    // Each batch is an input in its own right: a standby replays it at the same point
+    if (expired > 0 && !replica_) {
+        EngineEvent batch = EngineEvent::control(EngineEventType::EXPIRE_TIMERS);
+        batch.sequence = ++sequence_;
+        batch.tick = now_;
+        if (replication_) replication_->publish(batch);
+        publish_view();
+    }
+    return expired;
+}
+
+std::uint64_t MatchingEngine::to_tick(std::chrono::system_clock::time_point time) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count());
+}
+
+void MatchingEngine::cancel_client_orders(SessionId session, const CancelFilter& filter) {
+    const std::size_t canceled = book_.cancel_session_orders(session, filter, [this](const RestingOrder& order) {
+        view_.order_closed(order.id(), OrderStatus::CANCELED);
+        report_closed(ReportType::CANCELED, order);
+    });
+
+    if (canceled > 0 && !replica_) {
+        std::cout << "[Cancel] Session " << session << ": " << canceled << " order(s) canceled\n";
+    }
+}
+
+void MatchingEngine::cancel_inherited_sessions() {
+    // Their clients were connected to the old primary and cannot reach this one
+    for (SessionId session : book_.sessions()) {
+        EngineEvent cancel = EngineEvent::cancel_client(session);
+        submit(cancel);
     }
 }
 
+void MatchingEngine::uncross_auction(double reference_price) {
+    if (reference_price <= 0.0) reference_price = last_trade_price_;
+
+    AuctionResult result;
+    auto trades = book_.uncross(reference_price, result);
+    publish(trades);
+    in_auction_ = false;
+
+    if (!replica_) {
+        std::cout << "[Auction] Uncrossed " << result.volume << " @ " << result.price
+                  << " (imbalance " << result.imbalance << ")\n";
+    }
+}
+
+void MatchingEngine::publish(std::vector<Trade>& trades) {
+    if (trades.empty()) return;
+    last_trade_price_ = trades.back().price;
+    for (const Trade& trade : trades) {
+        view_.order_filled(trade.buy_order_id, trade.quantity);
+        view_.order_filled(trade.sell_order_id, trade.quantity);
+    }
+    if (replica_) return;  // The primary already reported these
+
+    const std::chrono::system_clock::time_point executed{std::chrono::milliseconds(now_)};
+    for (Trade& trade : trades) {
+        trade.timestamp = executed;
+        report_queue_.push(ExecutionReport::fill(std::move(trade)));
+    }
+}
+
+void MatchingEngine::report_closed(ReportType type, const Order& order) {
+    if (replica_) return;  // The primary already reported it
+    report_queue_.push(ExecutionReport::closed(type, order));
+}
+
+void MatchingEngine::publish_view() {
+    view_.publish_book(book_, sequence_, last_trade_price_, in_auction_);
+    applied_sequence_.store(sequence_, std::memory_order_release);
+}
+
 void MatchingEngine::stop() {
     running_ = false;
 }
@@ -37,3 +340,19 @@ void MatchingEngine::stop() {
 OrderBook& MatchingEngine::book() {
     return book_;
 }
+
+void MatchingEngine::set_day_close(std::chrono::system_clock::time_point close) {
+    day_close_ = to_tick(close);
+}
+
+void MatchingEngine::set_replication(ReplicationPublisher* publisher) {
+    replication_ = publisher;
+}
+
+void MatchingEngine::set_replica(bool replica) {
+    replica_ = replica;
+}
+
+void MatchingEngine::set_busy_poll(bool busy_poll) {
+    busy_poll_ = busy_poll;
+}
@@ -1,6 +1,8 @@
 #include "order.hpp"
 #include <sstream>
 #include <iomanip>
+#include <cmath>
+#include <limits>
 
 Order::Order()
     : id_(""), price_(0.0), quantity_(0), side_(OrderSide::BUY) {}
@@ -49,3 +51,14 @@ std::unique_ptr<Order> parse_order(const std::string& client_id, const std::stri
     OrderSide side = parse_order_side(side_str);
     return std::make_unique<Order>(client_id, price, quantity, side, OrderType::LIMIT);
 }
+
+RejectReason validate_order(const std::string& client_id, double price, long long quantity,
+                            TimeInForce tif, long long expiry_seconds) {
+    if (client_id.empty() || client_id.size() > kMaxClientIdLength) return RejectReason::CLIENT_ID;
+    if (quantity <= 0 || quantity > std::numeric_limits<int>::max()) return RejectReason::QUANTITY;
+    if (!std::isfinite(price) || price <= 0.0) return RejectReason::PRICE;
+    if (tif == TimeInForce::GTD && (expiry_seconds <= 0 || expiry_seconds > kMaxGtdSeconds)) {
+        return RejectReason::EXPIRY;
+    }
+    return RejectReason::NONE;
+}
@@ -1,76 +1,169 @@
 #define NOMINMAX
 #include "order_book.hpp"
 #include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <iterator>
 
-void OrderBook::add_order(const Order& order) {
-    auto& book = (order.side() == OrderSide::BUY) ? buy_orders_ : sell_orders_;
-    book[order.price()].push_back(order);
+OrderBook::OrderBook() : bids_(arena_), asks_(arena_) {}
+
+RestingOrder& OrderBook::add_order(Order order) {
+    RestingOrder& resting = (order.side() == OrderSide::BUY) ? bids_.add(std::move(order))
+                                                             : asks_.add(std::move(order));
+    if (resting.session_id() != kNoSession) {
+        client_orders_[resting.session_id()].push_back(resting);
+    }
+    return resting;
 }
 
-std::vector<Order> OrderBook::match_order(Order& incoming) {
-    std::vector<Order> matched;
-    int quantity_remaining = incoming.quantity();
-
-    // Shared inner matching logic for one price level
-    auto match_queue = [&](std::deque<Order>& queue) {
-        while (!queue.empty() && quantity_remaining > 0) {
-            Order& top = queue.front();
-            int traded_quantity = std::min(quantity_remaining, top.quantity());
-
-            if (traded_quantity == top.quantity()) {
-                matched.push_back(std::move(top));
-                queue.pop_front();
-            } else {
-                Order consumed = std::move(top);
-                queue.pop_front();
-
-                Order remainder(
-                    consumed.id(), consumed.client_id(),
-                    consumed.price(), consumed.quantity() - traded_quantity,
-                    consumed.side(),
-                    consumed.type(),
-                    consumed.timestamp()
-                );
-                queue.push_front(std::move(remainder));
-
-                consumed.set_quantity(traded_quantity);
-                matched.push_back(std::move(consumed));
-            }
-
-            quantity_remaining -= traded_quantity;
-        }
-    };
+void OrderBook::remove_order(RestingOrder& order) {
+    const SessionId session = order.session_id();
+    remove_from_side(order);
+    release_session(session);
+}
+
+void OrderBook::remove_from_side(RestingOrder& order) {
+    if (order.side() == OrderSide::BUY) {
+        bids_.remove(order);
+    } else {
+        asks_.remove(order);
+    }
+}
+
+void OrderBook::release_session(SessionId session) {
+    if (session == kNoSession) return;
+    auto list = client_orders_.find(session);
+    if (list != client_orders_.end() && list->second.empty()) client_orders_.erase(list);
+}
+
+std::vector<SessionId> OrderBook::sessions() const {
+    std::vector<SessionId> sessions;
+    sessions.reserve(client_orders_.size());
+    for (const auto& entry : client_orders_) {
+        sessions.push_back(entry.first);
+    }
+    return sessions;
+}
+
+void OrderBook::clear() {
+    // Orders unlink themselves from their session lists as they are destroyed
+    bids_.clear();
+    asks_.clear();
+    client_orders_.clear();
+}
+
+std::vector<Trade> OrderBook::match_order(Order& incoming) {
+    std::vector<Trade> trades;
 
     if (incoming.side() == OrderSide::BUY) {
-        auto it = sell_orders_.begin();
-        while (it != sell_orders_.end() && quantity_remaining > 0) {
-            if (it->first > incoming.price()) break;
+        asks_.sweep(incoming, trades);
+        for (const Trade& trade : trades) release_session(trade.sell_session);
+    } else {
+        bids_.sweep(incoming, trades);
+        for (const Trade& trade : trades) release_session(trade.buy_session);
+    }
+
+    return trades;
+}
 
-            match_queue(it->second);
+AuctionResult OrderBook::compute_auction(double reference_price) const {
+    AuctionResult result;
+    if (bids_.empty() || asks_.empty()) return result;
 
-            if (it->second.empty()) {
-                it = sell_orders_.erase(it);
-            } else {
-                ++it;
-            }
+    const double best_bid = bids_.best_price();
+    const double best_ask = asks_.best_price();
+    if (best_bid < best_ask) return result;  // Book does not cross
+
+    if (reference_price <= 0.0) reference_price = (best_bid + best_ask) / 2.0;
+
+    // Merge both sides into one ascending price ladder with per-price depth.
+    // Only prices inside [best_ask, best_bid] can maximise executed volume.
+    std::vector<double> prices;
+    std::vector<long long> bid_depth;
+    std::vector<long long> ask_depth;
+
+    const auto& bid_levels = bids_.levels();
+    const auto& ask_levels = asks_.levels();
+    auto bid = std::make_reverse_iterator(bid_levels.upper_bound(best_ask));  // Bids >= best_ask, ascending
+    const auto bid_end = bid_levels.rend();
+    auto ask = ask_levels.begin();
+    const auto ask_end = ask_levels.upper_bound(best_bid);
+
+    while (bid != bid_end || ask != ask_end) {
+        if (ask == ask_end || (bid != bid_end && bid->first < ask->first)) {
+            prices.push_back(bid->first);
+            bid_depth.push_back(bid->second.quantity);
+            ask_depth.push_back(0);
+            ++bid;
+        } else if (bid == bid_end || ask->first < bid->first) {
+            prices.push_back(ask->first);
+            bid_depth.push_back(0);
+            ask_depth.push_back(ask->second.quantity);
+            ++ask;
+        } else {
+            prices.push_back(bid->first);
+            bid_depth.push_back(bid->second.quantity);
+            ask_depth.push_back(ask->second.quantity);
+            ++bid;
+            ++ask;
         }
-    } else {
-        auto it = buy_orders_.rbegin();
-        while (it != buy_orders_.rend() && quantity_remaining > 0) {
-            if (it->first < incoming.price()) break;
-
-            match_queue(it->second);
-
-            if (it->second.empty()) {
-                it = std::make_reverse_iterator(
-                    buy_orders_.erase(std::next(it).base())
-                );
-            } else {
-                ++it;
-            }
+    }
+
+    // Cumulative demand at p: all bids priced >= p (suffix sum).
+    // Cumulative supply at p: all asks priced <= p (prefix sum).
+    const std::size_t n = prices.size();
+    std::vector<long long> demand(n);
+    std::vector<long long> supply(n);
+    std::partial_sum(bid_depth.rbegin(), bid_depth.rend(), demand.rbegin());
+    std::partial_sum(ask_depth.begin(), ask_depth.end(), supply.begin());
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const long long volume = std::min(demand[i], supply[i]);
+        const long long imbalance = demand[i] - supply[i];
+
+        bool better = volume > result.volume;
+        if (!better && volume == result.volume && volume > 0) {
+            const long long abs_imb = std::llabs(imbalance);
+            const long long best_abs_imb = std::llabs(result.imbalance);
+            better = abs_imb < best_abs_imb ||
+                     (abs_imb == best_abs_imb &&
+                      std::fabs(prices[i] - reference_price) < std::fabs(result.price - reference_price));
+        }
+
+        if (better) {
+            result.price = prices[i];
+            result.volume = volume;
+            result.imbalance = imbalance;
         }
     }
 
-    incoming.set_quantity(quantity_remaining);
-    return matched;
+    return result;
+}
+
+std::vector<Trade> OrderBook::uncross(double reference_price, AuctionResult& result) {
+    std::vector<Trade> trades;
+    result = compute_auction(reference_price);
+    if (result.volume == 0) return trades;
+
+    // Single pass: best bid vs best ask in time priority, every fill at the auction price
+    long long remaining = result.volume;
+    while (remaining > 0) {
+        Order& buy = bids_.front();
+        Order& sell = asks_.front();
+        const int traded_quantity = static_cast<int>(
+            std::min<long long>({remaining, buy.quantity(), sell.quantity()}));
+
+        trades.emplace_back(buy.client_id(), sell.client_id(), result.price, traded_quantity,
+                            buy.session_id(), sell.session_id(), buy.id(), sell.id());
+
+        remaining -= traded_quantity;
+        bids_.consume_front(traded_quantity);
+        asks_.consume_front(traded_quantity);
+    }
+
+    for (const Trade& trade : trades) {
+        release_session(trade.buy_session);
+        release_session(trade.sell_session);
+    }
+    return trades;
 }
@@ -1,19 +1,31 @@
 #include "order_server.hpp"
+#include "runtime_profile.hpp"
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <chrono>
 #include <thread>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
 
 // Constants
 constexpr int kBufferSize = 1024;
 constexpr int kSleepMs = 10;
+constexpr int kWriterIdleUs = 100;
+constexpr std::size_t kShmLivenessPolls = 1 << 16;  // Idle polls between socket liveness checks
+constexpr auto kShmIdleSleep = std::chrono::microseconds(50);  // Per empty poll once backed off
 
 #include "platform.hpp"
 
 
-OrderServer::OrderServer(ThreadSafeQueue<Order>& input_queue, ThreadSafeQueue<Trade>& trade_queue, int port)
-    : input_queue_(input_queue), trade_queue_(trade_queue), port_(port) {
+OrderServer::OrderServer(ThreadSafeQueue<EngineEvent>& input_queue, ThreadSafeQueue<ExecutionReport>& report_queue,
+                         int port, SessionId first_session_id)
+    : input_queue_(input_queue), report_queue_(report_queue), port_(port), next_session_id_(first_session_id) {
+    for (auto& session : sessions_) {
+        session = std::make_unique<Session>();
+    }
+
 #ifdef _WIN32
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
@@ -55,7 +67,7 @@ void OrderServer::start() {
     }
 
     accept_thread_ = std::thread(&OrderServer::accept_clients, this);
-    response_thread_ = std::thread(&OrderServer::send_trade_responses, this);
+    response_thread_ = std::thread(&OrderServer::route_reports, this);
 }
 
 void OrderServer::stop() {
@@ -64,90 +76,368 @@ void OrderServer::stop() {
     shutdown(listen_socket_, SHUT_RDWR);
     closesocket(listen_socket_);
 
+    // No new sessions after this; writers see running_ and shut their sockets,
+    // which unblocks the reader threads.
+    if (accept_thread_.joinable()) accept_thread_.join();
+
     for (auto& t : client_threads_) {
         if (t.joinable()) t.join();
     }
 
-    if (accept_thread_.joinable()) accept_thread_.join();
     if (response_thread_.joinable()) response_thread_.join();
 
 }
 
 void OrderServer::accept_clients() {
+    pin_current_thread_or_warn(cpu_core_, "order server accept");
     while (running_) {
         SOCKET client_socket = accept(listen_socket_, nullptr, nullptr);
         if (client_socket != INVALID_SOCKET) {
-            client_threads_.emplace_back(&OrderServer::handle_client, this, client_socket);
+            SessionId session_id = open_session(client_socket);
+            if (session_id == kNoSession) {
+                std::cerr << "Session table full, rejecting client.\n";
+                closesocket(client_socket);
+                continue;
+            }
+            client_threads_.emplace_back(&OrderServer::handle_client, this, session_id);
         }
     }
 
 }
 
-void OrderServer::handle_client(SOCKET client_socket) {
+SessionId OrderServer::open_session(SOCKET client_socket) {
+    for (std::size_t attempt = 0; attempt < kMaxSessions; ++attempt) {
+        SessionId candidate = next_session_id_++;
+        if (candidate == kNoSession) candidate = next_session_id_++;  // skip on wrap-around
+
+        Session& session = *sessions_[candidate % kMaxSessions];
+        if (session.handle.load(std::memory_order_acquire) != kNoSession) continue;
+
+        session.socket = client_socket;
+        session.open.store(true, std::memory_order_relaxed);
+        session.handle.store(candidate, std::memory_order_release);
+        return candidate;
+    }
+    return kNoSession;
+}
+
+OrderServer::Session* OrderServer::find_session(SessionId session_id) const {
+    if (session_id == kNoSession) return nullptr;
+    Session* session = sessions_[session_id % kMaxSessions].get();
+    return (session->handle.load(std::memory_order_acquire) == session_id) ? session : nullptr;
+}
+
+void OrderServer::handle_client(SessionId session_id) {
+    Session& session = *find_session(session_id);
+    SOCKET client_socket = session.socket;
+    std::thread writer(&OrderServer::write_session, this, session_id);
+
     char buffer[kBufferSize];
     int bytesReceived;
-
-    while ((bytesReceived = recv(client_socket, buffer, kBufferSize - 1, 0)) > 0) {
+    bool first_line = true;
+    bool shm_mode = false;
+
+    // An ACK or REJECT must never go missing: a client that lets its replies back up is disconnected
+    auto reply_or_disconnect = [&](std::string text) {
+        if (session.replies.try_push(std::move(text))) return;
+        std::cerr << "Session " << session_id << " reply queue full, disconnecting.\n";
+        session.open.store(false, std::memory_order_release);
+    };
+
+    while (!shm_mode && session.open.load(std::memory_order_acquire) &&
+           (bytesReceived = recv(client_socket, buffer, kBufferSize - 1, 0)) > 0) {
         buffer[bytesReceived] = '\0';
         std::istringstream stream(buffer);
         std::string line;
 
-        while (std::getline(stream, line)) {
+        while (session.open.load(std::memory_order_acquire) && std::getline(stream, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            if (first_line && line == "SHM") {
+                shm_mode = open_shm_channel(session, session_id);
+                break;
+            }
+            first_line = false;
+
+            auto reject = [&](RejectReason reason) {
+                std::cerr << "Rejected (" << to_string(reason) << "): " << line << "\n";
+                reply_or_disconnect("REJECT " + to_string(reason) + "\n");
+            };
+
+            std::string reply;
+            CancelFilter filter;
+            try {
+                if (parse_cancel_all(line, filter)) {
+                    input_queue_.push(EngineEvent::cancel_client(session_id, filter));
+                    reply_or_disconnect("ACK CANCEL_ALL\n");
+                    continue;
+                }
+            } catch (const std::exception&) {
+                reject(RejectReason::MALFORMED);
+                continue;
+            }
+
+            if (answer_query(line, reply)) {
+                if (!session.replies.try_push(reply + "\n")) {
+                    std::cerr << "Session " << session_id << " reply queue full, dropping reply.\n";
+                }
+                continue;
+            }
+
             std::istringstream ss(line);
-            std::string client_id, price_str, qty_str, side_str;
+            std::string client_id, price_str, qty_str, side_str, tif_str, expiry_str;
 
+            // CLIENT_ID,PRICE,QUANTITY,SIDE[,TIF[,SECONDS_TO_EXPIRY]]
             if (std::getline(ss, client_id, ',') &&
                 std::getline(ss, price_str, ',') &&
                 std::getline(ss, qty_str, ',') &&
-                std::getline(ss, side_str)) {
+                std::getline(ss, side_str, ',')) {
+                std::getline(ss, tif_str, ',');
+                std::getline(ss, expiry_str);
 
-                try {
-                    double price = std::stod(price_str);
-                    int qty = std::stoi(qty_str);
-                    OrderSide side = (side_str == "BUY") ? OrderSide::BUY : OrderSide::SELL;
+                if (side_str != "BUY" && side_str != "SELL") {
+                    reject(RejectReason::SIDE);
+                    continue;
+                }
 
-                    Order order(client_id, price, qty, side);
+                double price;
+                long long qty;
+                long long expiry_seconds = 0;
+                OrderSide side;
+                TimeInForce tif;
+                try {
+                    price = std::stod(price_str);
+                    qty = std::stoll(qty_str);
+                    side = parse_order_side(side_str);
+                    tif = parse_time_in_force(tif_str);
+                    if (tif == TimeInForce::GTD) expiry_seconds = std::stoll(expiry_str);
+                } catch (const std::exception&) {
+                    reject(RejectReason::MALFORMED);
+                    continue;
+                }
 
-                    {
-                        std::lock_guard<std::mutex> lock(socket_mutex_);
-                        client_sockets_[client_id] = client_socket;
-                    }
+                const RejectReason reason = validate_order(client_id, price, qty, tif, expiry_seconds);
+                if (reason != RejectReason::NONE) {
+                    reject(reason);
+                    continue;
+                }
 
-                    input_queue_.push(std::move(order));
-                } catch (const std::exception& e) {
-                    std::cerr << "Invalid order format: " << line << "\n";
+                Order order(client_id, price, static_cast<int>(qty), side);
+                order.set_session_id(session_id);
+                if (tif == TimeInForce::GTD) {
+                    order.set_time_in_force(tif, order.timestamp() + std::chrono::seconds(expiry_seconds));
+                } else {
+                    order.set_time_in_force(tif);
                 }
+
+                std::string ack = "ACK " + order.id() + "\n";
+                input_queue_.push(EngineEvent::new_order(std::move(order)));
+                reply_or_disconnect(std::move(ack));
+            } else {
+                reject(RejectReason::MALFORMED);
             }
         }
     }
 
+    if (shm_mode) {
+        poll_shm_channel(session, session_id);
+    }
+
+    session.open.store(false, std::memory_order_release);
+    if (writer.joinable()) writer.join();
+    while (session.replies.try_pop()) {}  // Unsent replies must not reach the slot's next occupant
+    while (session.shm_replies.try_pop()) {}
+
+    // Cancel on disconnect: nothing this session left resting may trade once it is gone
+    input_queue_.push(EngineEvent::cancel_client(session_id));
+
+    session.shm_region.store(nullptr, std::memory_order_release);
+    session.shm.reset();
     closesocket(client_socket);
+    session.socket = INVALID_SOCKET;
+    session.handle.store(kNoSession, std::memory_order_release);
 }
 
-void OrderServer::send_trade_responses() {
+bool OrderServer::open_shm_channel(Session& session, SessionId session_id) {
+    // Sent directly: the client places no orders until it has the reply
+    session.shm = ShmChannel::create(ShmChannel::name_for(session_id));
+    const std::string reply = session.shm
+        ? "SHM " + session.shm->name() + "\n"
+        : std::string("ERROR shared memory unavailable\n");
+    send(session.socket, reply.c_str(), static_cast<int>(reply.length()), 0);
+
+    if (!session.shm) return false;
+    session.shm_region.store(&session.shm->region(), std::memory_order_release);
+    return true;
+}
+
+void OrderServer::poll_shm_channel(Session& session, SessionId session_id) {
+    ShmRegion& region = session.shm->region();
+    IdleBackoff backoff(kShmIdleSleep);
+    std::size_t idle_polls = 0;
+
+    while (running_ && session.open.load(std::memory_order_acquire)) {
+        auto message = region.inbound.try_pop();
+        if (!message) {
+            const bool slept = backoff.idle();
+            if (++idle_polls % kShmLivenessPolls == 0 || slept) {
+#ifndef _WIN32
+                // The TCP connection stays open purely as a liveness signal
+                char probe;
+                const int bytes = recv(session.socket, &probe, 1, MSG_DONTWAIT);
+                if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) break;
+#endif
+            }
+            continue;
+        }
+        idle_polls = 0;
+        backoff.reset();
+
+        // The client writes raw bytes: check every field before it becomes an enum or an order
+        const RejectReason reason = check_shm_request(*message);
+        if (reason != RejectReason::NONE) {
+            if (!session.shm_replies.try_push(ShmReportMessage::rejected(*message, reason))) {
+                std::cerr << "Session " << session_id << " reply queue full, disconnecting.\n";
+                break;
+            }
+            continue;
+        }
+
+        if (message->kind == ShmOrderMessage::CANCEL_ALL) {
+            CancelFilter filter;
+            if (message->side_filter) filter.side = static_cast<OrderSide>(message->side);
+            filter.price = message->price;
+            input_queue_.push(EngineEvent::cancel_client(session_id, filter));
+            continue;
+        }
+
+        Order order(message->client_id, message->price, message->quantity,
+                    static_cast<OrderSide>(message->side));
+        order.set_session_id(session_id);
+
+        const auto tif = static_cast<TimeInForce>(message->time_in_force);
+        if (tif == TimeInForce::GTD) {
+            order.set_time_in_force(tif, order.timestamp() + std::chrono::seconds(message->expiry_seconds));
+        } else {
+            order.set_time_in_force(tif);
+        }
+
+        input_queue_.push(EngineEvent::new_order(std::move(order)));
+    }
+}
+
+RejectReason OrderServer::check_shm_request(const ShmOrderMessage& message) {
+    const bool valid_side = message.side <= static_cast<std::uint8_t>(OrderSide::SELL);
+
+    if (message.kind == ShmOrderMessage::CANCEL_ALL) {
+        if (message.side_filter && !valid_side) return RejectReason::SIDE;
+        if (!std::isfinite(message.price) || message.price < 0.0) return RejectReason::PRICE;
+        return RejectReason::NONE;
+    }
+    if (message.kind != ShmOrderMessage::NEW_ORDER) return RejectReason::MALFORMED;
+
+    if (!std::memchr(message.client_id, '\0', sizeof(message.client_id))) return RejectReason::CLIENT_ID;
+    if (!valid_side) return RejectReason::SIDE;
+    if (message.time_in_force > static_cast<std::uint8_t>(TimeInForce::GTD)) return RejectReason::TIME_IN_FORCE;
+
+    return validate_order(message.client_id, message.price, message.quantity,
+                          static_cast<TimeInForce>(message.time_in_force), message.expiry_seconds);
+}
+
+void OrderServer::write_session(SessionId session_id) {
+    Session& session = *find_session(session_id);
+    IdleBackoff backoff(kShmIdleSleep);  // Shared memory, or any session when busy polling
+
+    while (running_ && session.open.load(std::memory_order_acquire)) {
+        ShmRegion* shm_region = session.shm_region.load(std::memory_order_acquire);
+
+        if (auto reply = session.replies.try_pop()) {
+            if (send(session.socket, reply->c_str(), static_cast<int>(reply->length()), 0) == SOCKET_ERROR) {
+                break;
+            }
+            backoff.reset();
+            continue;
+        }
+
+        if (shm_region) {
+            if (auto rejection = session.shm_replies.try_pop()) {
+                if (!shm_region->outbound.try_push(*rejection)) {
+                    std::cerr << "Session " << session_id << " shared-memory ring full, disconnecting.\n";
+                    break;
+                }
+                backoff.reset();
+                continue;
+            }
+        }
+
+        auto report = session.outbound.try_pop();
+        if (!report) {
+            if (shm_region || busy_poll_) {
+                backoff.idle();  // Spin first, then yield and sleep: never a core per session
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(kWriterIdleUs));
+            }
+            continue;
+        }
+
+        backoff.reset();
+
+        // Reports queued for a previous occupant of this slot are dropped
+        if (!report->addressed_to(session_id)) continue;
+
+        if (shm_region) {
+            if (!shm_region->outbound.try_push(ShmReportMessage::from_report(*report))) {
+                std::cerr << "Session " << session_id << " shared-memory ring full, disconnecting.\n";
+                break;
+            }
+            continue;
+        }
+
+        std::string msg = report->to_string() + "\n";
+        if (send(session.socket, msg.c_str(), static_cast<int>(msg.length()), 0) == SOCKET_ERROR) {
+            break;
+        }
+    }
+
+    // Unblocks the reader thread if we are the ones ending the session
+    session.open.store(false, std::memory_order_release);
+    shutdown(session.socket, SD_BOTH);
+}
+
+void OrderServer::route_reports() {
+    pin_current_thread_or_warn(cpu_core_, "report router");
     while (running_) {
-        auto trade = trade_queue_.try_pop();
-        if (trade) {
-            std::string msg = trade->to_string() + "\n";
+        auto report = report_queue_.try_pop();
+        if (report) {
+            auto deliver = [&](SessionId session_id) {
+                Session* session = find_session(session_id);
+                if (!session) return;
+                if (!session->outbound.try_push(*report)) {
+                    // Slow consumer: cut it loose rather than stall everyone else
+                    std::cerr << "Session " << session_id << " outbound queue full, disconnecting.\n";
+                    session->open.store(false, std::memory_order_release);
+                }
+            };
 
-            {
-                std::lock_guard<std::mutex> lock(socket_mutex_);
-                auto send_to = [&](const std::string& client_id) {
-                    auto it = client_sockets_.find(client_id);
-                    if (it != client_sockets_.end()) {
-                        SOCKET sock = it->second;
-                        send(sock, msg.c_str(), static_cast<int>(msg.length()), 0);
-                    }
-                };
-
-                send_to(trade->buy_client_id);
-                send_to(trade->sell_client_id);
+            if (report->type != ReportType::TRADE) {
+                deliver(report->session);
+                continue;
+            }
+
+            const Trade& trade = report->trade;
+            deliver(trade.buy_session);
+            if (trade.sell_session != trade.buy_session) {
+                deliver(trade.sell_session);
             }
 
+            if (analytics_) analytics_->record(trade);
+
             {
                 std::lock_guard<std::mutex> lock(log_mutex_);
-                trade_log_.push_back(*trade);
+                trade_log_.push_back(trade);
             }
+        } else if (busy_poll_) {
+            cpu_relax();  // Low-latency: a report is forwarded as soon as the engine queues it
         } else {
             std::this_thread::sleep_for(std::chrono::milliseconds(kSleepMs));
         }
@@ -155,6 +445,44 @@ void OrderServer::send_trade_responses() {
 
 }
 
+bool OrderServer::answer_query(const std::string& line, std::string& reply) const {
+    // Whole-line matches only: an order whose client ID merely starts with a verb is still an order
+    const bool status_query = line.rfind("STATUS,", 0) == 0 && line.find(',', 7) == std::string::npos;
+    if (!status_query && line != "BOOK") return false;
+
+    if (!book_view_) {
+        reply = "ERROR queries unavailable";
+        return true;
+    }
+
+    std::ostringstream oss;
+    if (status_query) {
+        // STATUS,ORDER_ID
+        const std::string order_id = line.substr(7);
+        OrderStatusRecord record;
+        oss << "STATUS " << order_id << " ";
+        if (book_view_->order_status(order_id, record)) {
+            oss << to_string(record.status) << " FILLED " << record.filled_quantity
+                << " LEAVES " << record.leaves_quantity();
+        } else {
+            oss << to_string(OrderStatus::UNKNOWN);
+        }
+    } else {
+        // BOOK: top of book as of the engine's last applied input
+        const BookSnapshot book = book_view_->snapshot();
+        oss << "BOOK " << book.sequence << " BID ";
+        if (book.bid_levels > 0) oss << book.bids[0].quantity << " @ " << book.bids[0].price;
+        else oss << "-";
+        oss << " ASK ";
+        if (book.ask_levels > 0) oss << book.asks[0].quantity << " @ " << book.asks[0].price;
+        else oss << "-";
+        oss << " LAST " << book.last_trade_price;
+    }
+
+    reply = oss.str();
+    return true;
+}
+
 void OrderServer::write_trade_log_to_file(const std::string& filename) const {
     std::ofstream file(filename);
     if (!file.is_open()) {
@@ -0,0 +1,648 @@
+#include "replication.hpp"
+#include "matching_engine.hpp"
+#include "runtime_profile.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+    #include <sys/un.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+// Constants
+constexpr int kIdleUs = 50;
+constexpr int kReconnectMs = 200;  // Between a standby's attempts to reach the primary
+constexpr const char* kUnixPrefix = "unix:";
+
+namespace {
+
+std::uint64_t to_ms(std::chrono::system_clock::time_point time) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count());
+}
+
+std::uint64_t wall_clock_ns() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void copy_field(char (&dest)[24], const std::string& src) {
+    const std::size_t length = std::min(src.size(), sizeof(dest) - 1);
+    std::memcpy(dest, src.data(), length);
+    dest[length] = '\0';
+}
+
+void encode_order(ReplicationRecord& record, const Order& order) {
+    record.price = order.price();
+    record.quantity = order.quantity();
+    record.session = order.session_id();
+    record.side = static_cast<std::uint8_t>(order.side());
+    record.time_in_force = static_cast<std::uint8_t>(order.time_in_force());
+    record.expire_tick = (order.time_in_force() != TimeInForce::GTC) ? to_ms(order.expire_time()) : 0;
+    copy_field(record.order_id, order.id());
+    copy_field(record.client_id, order.client_id());
+}
+
+/// The order a NEW_ORDER or RESTORE_ORDER record carries, timestamped at its tick
+Order decode_order(const ReplicationRecord& record) {
+    Order order(record.order_id, record.client_id, record.price, record.quantity,
+                static_cast<OrderSide>(record.side), OrderType::LIMIT,
+                std::chrono::system_clock::time_point(std::chrono::milliseconds(record.tick)));
+    order.set_session_id(record.session);
+    order.set_time_in_force(static_cast<TimeInForce>(record.time_in_force),
+                            std::chrono::system_clock::time_point(std::chrono::milliseconds(record.expire_tick)));
+    return order;
+}
+
+/**
+ * @brief Opens a listening or connected stream socket for "host:port" or "unix:/path".
+ */
+SOCKET open_endpoint(const std::string& endpoint, bool listening) {
+    if (endpoint.rfind(kUnixPrefix, 0) == 0) {
+#ifdef _WIN32
+        std::cerr << "Unix domain sockets are not supported on this platform: " << endpoint << "\n";
+        return INVALID_SOCKET;
+#else
+        const std::string path = endpoint.substr(std::strlen(kUnixPrefix));
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Invalid Unix socket path: " << path << "\n";
+            return INVALID_SOCKET;
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        SOCKET sock = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (sock == INVALID_SOCKET) return INVALID_SOCKET;
+
+        if (listening) {
+            unlink(path.c_str());
+            if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR ||
+                listen(sock, SOMAXCONN) == SOCKET_ERROR) {
+                closesocket(sock);
+                return INVALID_SOCKET;
+            }
+        } else if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+            closesocket(sock);
+            return INVALID_SOCKET;
+        }
+        return sock;
+#endif
+    }
+
+    const std::size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos) {
+        std::cerr << "Invalid endpoint (expected host:port or unix:/path): " << endpoint << "\n";
+        return INVALID_SOCKET;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<unsigned short>(std::stoi(endpoint.substr(colon + 1))));
+    if (inet_pton(AF_INET, endpoint.substr(0, colon).c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Invalid IPv4 address in endpoint: " << endpoint << "\n";
+        return INVALID_SOCKET;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) return INVALID_SOCKET;
+
+    // Records are batched by the publisher; don't let Nagle hold them back
+    int opt = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&opt), sizeof(opt));
+
+    if (listening) {
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char*>(&opt), sizeof(opt));
+        if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR ||
+            listen(sock, SOMAXCONN) == SOCKET_ERROR) {
+            closesocket(sock);
+            return INVALID_SOCKET;
+        }
+    } else if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+        closesocket(sock);
+        return INVALID_SOCKET;
+    }
+    return sock;
+}
+
+bool send_all(SOCKET sock, const char* data, std::size_t length) {
+    while (length > 0) {
+        const int sent = send(sock, data, static_cast<int>(length), MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data += sent;
+        length -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace
+
+// --- ReplicationRecord ---
+
+ReplicationRecord ReplicationRecord::from_event(const EngineEvent& event) {
+    ReplicationRecord record = {};
+    record.sequence = event.sequence;
+    record.tick = event.tick;
+    record.sent_ns = wall_clock_ns();
+    record.type = static_cast<std::uint8_t>(event.type);
+    record.reference_price = event.reference_price;
+
+    if (event.type == EngineEventType::NEW_ORDER) {
+        encode_order(record, event.order);
+    } else if (event.type == EngineEventType::CANCEL_CLIENT) {
+        const CancelFilter& filter = event.cancel_filter;
+        record.session = event.session;
+        record.price = filter.price;
+        record.side_filter = filter.side.has_value();
+        record.side = static_cast<std::uint8_t>(filter.side.value_or(OrderSide::BUY));
+    } else if (event.type == EngineEventType::SNAPSHOT) {
+        const SnapshotState& state = event.snapshot;
+        record.expire_tick = state.day_close;
+        record.timer_tick = state.timer_tick;
+        record.order_number = state.order_number;
+        record.price = state.last_trade_price;
+        record.side_filter = state.in_auction;
+        record.quantity = static_cast<std::int32_t>(state.orders);
+    }
+    return record;
+}
+
+ReplicationRecord ReplicationRecord::restore(const Order& order, std::uint64_t sequence,
+                                             const TimerPosition& timer) {
+    ReplicationRecord record = {};
+    record.sequence = sequence;
+    record.tick = to_ms(order.timestamp());
+    record.sent_ns = wall_clock_ns();
+    record.type = static_cast<std::uint8_t>(EngineEventType::RESTORE_ORDER);
+    record.timer_rank = timer.rank;
+    record.timer_level = timer.level;
+    record.timer_slot = timer.slot;
+    encode_order(record, order);
+    return record;
+}
+
+EngineEvent ReplicationRecord::to_event() const {
+    EngineEvent event = EngineEvent::control(static_cast<EngineEventType>(type), reference_price);
+    event.sequence = sequence;
+    event.tick = tick;
+
+    if (event.type == EngineEventType::NEW_ORDER) {
+        event.order = decode_order(*this);
+    } else if (event.type == EngineEventType::CANCEL_CLIENT) {
+        event.session = session;
+        event.cancel_filter.price = price;
+        if (side_filter) event.cancel_filter.side = static_cast<OrderSide>(side);
+    } else if (event.type == EngineEventType::SNAPSHOT) {
+        event.snapshot.day_close = expire_tick;
+        event.snapshot.timer_tick = timer_tick;
+        event.snapshot.order_number = order_number;
+        event.snapshot.last_trade_price = price;
+        event.snapshot.in_auction = side_filter != 0;
+        event.snapshot.orders = static_cast<std::uint32_t>(quantity);
+    } else if (event.type == EngineEventType::RESTORE_ORDER) {
+        event.order = decode_order(*this);
+        event.timer.rank = timer_rank;
+        event.timer.level = timer_level;
+        event.timer.slot = timer_slot;
+    }
+    return event;
+}
+
+// --- ReplicationPublisher ---
+
+struct ReplicationPublisher::SnapshotBuilder {
+    MatchingEngine::EventQueue input;
+    MatchingEngine::ReportQueue reports;  // Stays empty: a replica reports nothing
+    MatchingEngine engine{input, reports};
+    std::thread thread;
+};
+
+ReplicationPublisher::ReplicationPublisher(std::string endpoint)
+    : endpoint_(std::move(endpoint)) {}
+
+ReplicationPublisher::~ReplicationPublisher() {
+    stop();
+}
+
+bool ReplicationPublisher::start() {
+    listen_socket_ = open_endpoint(endpoint_, true);
+    if (listen_socket_ == INVALID_SOCKET) {
+        std::cerr << "Failed to listen for standbys on " << endpoint_ << "\n";
+        return false;
+    }
+
+    // Follows the journal like a standby, so snapshots never cost the primary's engine thread a step
+    builder_ = std::make_unique<SnapshotBuilder>();
+    builder_->engine.set_replica(true);
+    builder_->engine.set_replication(this);
+    builder_->thread = std::thread(&MatchingEngine::run, &builder_->engine);
+
+    running_ = true;
+    accept_thread_ = std::thread(&ReplicationPublisher::accept_standbys, this);
+    publisher_thread_ = std::thread(&ReplicationPublisher::stream, this);
+    return true;
+}
+
+void ReplicationPublisher::stop() {
+    if (!running_.exchange(false)) return;
+
+    shutdown(listen_socket_, SD_BOTH);
+    closesocket(listen_socket_);
+
+    if (accept_thread_.joinable()) accept_thread_.join();
+    if (publisher_thread_.joinable()) publisher_thread_.join();
+
+    builder_->input.push(EngineEvent::control(EngineEventType::SHUTDOWN));
+    builder_->thread.join();
+}
+
+void ReplicationPublisher::publish(const EngineEvent& event) {
+    const ReplicationRecord record = ReplicationRecord::from_event(event);
+    while (!ring_.try_push(record)) {
+        std::this_thread::yield();  // Backpressure: the publisher thread is behind
+    }
+    published_sequence_.store(event.sequence, std::memory_order_relaxed);
+}
+
+void ReplicationPublisher::publish_snapshot(const EngineEvent& header) {
+    const ReplicationRecord record = ReplicationRecord::from_event(header);
+    while (!snapshot_ring_.try_push(record) && running_) {
+        std::this_thread::yield();  // Dropped only once stop() has ended the publisher thread
+    }
+}
+
+void ReplicationPublisher::publish_restore(const Order& order, std::uint64_t sequence, const TimerPosition& timer) {
+    const ReplicationRecord record = ReplicationRecord::restore(order, sequence, timer);
+    while (!snapshot_ring_.try_push(record) && running_) {
+        std::this_thread::yield();
+    }
+}
+
+std::size_t ReplicationPublisher::standby_count() const {
+    std::lock_guard<std::mutex> lock(standby_mutex_);
+    return standby_count_;
+}
+
+void ReplicationPublisher::accept_standbys() {
+    pin_current_thread_or_warn(cpu_core_, "replication accept");
+    while (running_) {
+        SOCKET standby = accept(listen_socket_, nullptr, nullptr);
+        if (standby == INVALID_SOCKET) continue;
+
+        int opt = 1;
+        setsockopt(standby, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&opt), sizeof(opt));
+
+        std::lock_guard<std::mutex> lock(standby_mutex_);
+        pending_standbys_.push_back(standby);
+        std::cout << "[Replication] Standby connected\n";
+    }
+}
+
+void ReplicationPublisher::stream() {
+    pin_current_thread_or_warn(cpu_core_, "replication publisher");
+    while (running_ || !ring_.empty()) {
+        {
+            // New standbys wait for their resume point before anything is sent
+            std::lock_guard<std::mutex> lock(standby_mutex_);
+            for (SOCKET standby : pending_standbys_) {
+                standbys_.push_back(Standby{standby});
+            }
+            pending_standbys_.clear();
+            standby_count_ = standbys_.size();
+        }
+
+        std::size_t drained = 0;
+        while (drained < kMaxBatch) {
+            auto record = ring_.try_pop();
+            if (!record) break;
+            ++drained;
+            if (journal_.empty()) journal_front_ = record->sequence;
+            journal_.push_back(*record);
+            builder_->input.push(record->to_event());
+        }
+        for (std::size_t collected = 0; collected < kMaxBatch; ++collected) {
+            auto record = snapshot_ring_.try_pop();
+            if (!record) break;
+            ++drained;
+            collect_snapshot(*record);
+        }
+
+        // Pipeline: one write per standby per pass, no per-record round trip
+        bool sent_any = false;
+        std::uint64_t slowest_sent = journal_end();
+        std::uint64_t slowest_acked = UINT64_MAX;
+        std::uint64_t needed = UINT64_MAX;  // Oldest sequence a connected standby may still ask for
+        for (auto it = standbys_.begin(); it != standbys_.end();) {
+            if (!read_acks(*it) || !serve(*it, sent_any)) {
+                std::cerr << "[Replication] Standby disconnected\n";
+                closesocket(it->socket);
+                it = standbys_.erase(it);
+                continue;
+            }
+            if (it->next != 0) {
+                needed = std::min(needed, it->snapshot ? it->next : it->acked + 1);
+                if (!it->snapshot) {
+                    slowest_sent = std::min(slowest_sent, it->next);
+                    slowest_acked = std::min(slowest_acked, it->acked);
+                }
+            }
+            ++it;
+        }
+
+        if (slowest_acked != UINT64_MAX) {
+            sent_sequence_.store(slowest_sent - 1, std::memory_order_relaxed);
+            acked_sequence_.store(slowest_acked, std::memory_order_relaxed);
+        }
+        trim_journal(needed);
+
+        if (drained == 0 && !sent_any) {
+            std::this_thread::sleep_for(std::chrono::microseconds(kIdleUs));
+        }
+    }
+
+    for (const Standby& standby : standbys_) {
+        shutdown(standby.socket, SD_BOTH);
+        closesocket(standby.socket);
+    }
+    standbys_.clear();
+}
+
+bool ReplicationPublisher::read_acks(Standby& standby) {
+    while (true) {
+        char* const into = standby.ack + standby.ack_filled;
+        const int wanted = static_cast<int>(sizeof(standby.ack) - standby.ack_filled);
+#ifdef _WIN32
+        u_long available = 0;
+        if (ioctlsocket(standby.socket, FIONREAD, &available) != 0) return false;
+        if (available == 0) return true;
+        const int bytes = recv(standby.socket, into, wanted, 0);
+#else
+        const int bytes = recv(standby.socket, into, wanted, MSG_DONTWAIT);
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+#endif
+        if (bytes <= 0) return false;
+
+        standby.ack_filled += static_cast<std::size_t>(bytes);
+        if (standby.ack_filled < sizeof(standby.ack)) continue;
+        standby.ack_filled = 0;
+
+        std::uint64_t sequence;
+        std::memcpy(&sequence, standby.ack, sizeof(sequence));
+        if (!standby.resumed) {
+            standby.resumed = true;  // The first value is where the standby wants to resume from
+            standby.acked = sequence;
+        } else {
+            standby.acked = std::max(standby.acked, sequence);
+        }
+    }
+}
+
+bool ReplicationPublisher::serve(Standby& standby, bool& sent_any) {
+    if (!standby.resumed) return true;  // Nothing is sent until the standby says where it is
+
+    if (standby.next == 0) {
+        // kResumeFromSnapshot wraps to 0, which is never journaled
+        if (!position(standby, standby.acked + 1)) return true;
+    } else if (!standby.snapshot && standby.next < journal_front_) {
+        std::cerr << "[Replication] Standby fell behind the journal at sequence " << standby.next << "\n";
+        if (!position(standby, standby.next)) return true;
+    }
+
+    if (standby.snapshot) {
+        const Snapshot& records = *standby.snapshot;
+        const std::size_t count = std::min(records.size() - standby.snapshot_sent, kMaxBatch);
+        if (!send_all(standby.socket, reinterpret_cast<const char*>(records.data() + standby.snapshot_sent),
+                      count * sizeof(ReplicationRecord))) {
+            return false;
+        }
+        standby.snapshot_sent += count;
+        if (standby.snapshot_sent == records.size()) standby.snapshot.reset();
+        sent_any = true;
+        return true;
+    }
+
+    if (standby.next >= journal_end()) return true;
+
+    const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(journal_end() - standby.next, kMaxBatch));
+    const auto first = journal_.begin() + static_cast<std::ptrdiff_t>(standby.next - journal_front_);
+    batch_.assign(first, first + static_cast<std::ptrdiff_t>(count));
+    if (!send_all(standby.socket, reinterpret_cast<const char*>(batch_.data()), count * sizeof(ReplicationRecord))) {
+        return false;
+    }
+    standby.next += count;
+    sent_any = true;
+    return true;
+}
+
+bool ReplicationPublisher::position(Standby& standby, std::uint64_t resume) {
+    if (resume >= journal_front_ && resume <= journal_end()) {
+        standby.next = resume;
+        std::cout << "[Replication] Standby resuming at sequence " << resume << "\n";
+        return true;
+    }
+
+    standby.next = 0;
+    if (!snapshot_) {
+        request_snapshot();
+        return false;  // Held until the builder's snapshot arrives
+    }
+
+    // Whatever the standby acknowledged before is superseded by the snapshot
+    standby.snapshot = snapshot_;
+    standby.snapshot_sent = 0;
+    standby.next = snapshot_sequence() + 1;
+    standby.acked = 0;
+    std::cout << "[Replication] Sending standby the snapshot at sequence " << snapshot_sequence()
+              << " (" << snapshot_->size() - 1 << " resting orders), then the journal\n";
+    return true;
+}
+
+void ReplicationPublisher::collect_snapshot(const ReplicationRecord& record) {
+    if (static_cast<EngineEventType>(record.type) == EngineEventType::SNAPSHOT) {
+        building_.clear();
+        building_.push_back(record);
+        building_remaining_ = static_cast<std::size_t>(record.quantity);
+    } else {
+        building_.push_back(record);
+        --building_remaining_;
+    }
+
+    if (building_remaining_ == 0) {
+        snapshot_ = std::make_shared<const Snapshot>(std::move(building_));
+        building_ = Snapshot();
+        snapshot_pending_ = false;
+    }
+}
+
+void ReplicationPublisher::request_snapshot() {
+    if (snapshot_pending_) return;
+    snapshot_pending_ = true;
+    // Queued behind every journaled record, so the builder's book is exactly as of journal_end() - 1
+    builder_->input.push(EngineEvent::control(EngineEventType::TAKE_SNAPSHOT));
+}
+
+void ReplicationPublisher::trim_journal(std::uint64_t needed) {
+    // Everything after the latest snapshot stays, so a new standby can catch up from it
+    const std::uint64_t keep_from = snapshot_sequence() + 1;
+    std::uint64_t trim_to = std::min(keep_from, needed);
+    if (snapshot_ && journal_.size() > kMaxJournal) {
+        trim_to = keep_from;  // Standbys that lag further get the snapshot instead
+    }
+    if (!snapshot_) trim_to = journal_front_;
+
+    while (journal_front_ < trim_to && !journal_.empty()) {
+        journal_.pop_front();
+        ++journal_front_;
+    }
+
+    if (journal_end() - 1 >= snapshot_sequence() + kSnapshotInterval) request_snapshot();
+}
+
+// --- ReplicaReceiver ---
+
+ReplicaReceiver::ReplicaReceiver(std::string endpoint, ThreadSafeQueue<EngineEvent>& engine_queue)
+    : endpoint_(std::move(endpoint)), engine_queue_(engine_queue) {}
+
+ReplicaReceiver::~ReplicaReceiver() {
+    stop();
+}
+
+bool ReplicaReceiver::start() {
+    const SOCKET sock = open_endpoint(endpoint_, false);
+    if (sock == INVALID_SOCKET) {
+        std::cerr << "Failed to connect to primary at " << endpoint_ << "\n";
+        return false;
+    }
+
+    socket_ = sock;
+    running_ = true;
+    connected_ = true;
+    receive_thread_ = std::thread(&ReplicaReceiver::receive, this);
+    return true;
+}
+
+void ReplicaReceiver::stop() {
+    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(socket_mutex_);
+        if (socket_ != INVALID_SOCKET) shutdown(socket_, SD_BOTH);
+    }
+    if (receive_thread_.joinable()) receive_thread_.join();
+}
+
+void ReplicaReceiver::receive() {
+    pin_current_thread_or_warn(cpu_core_, "replication receiver");
+    while (true) {
+        follow();
+
+        {
+            std::lock_guard<std::mutex> lock(socket_mutex_);
+            closesocket(socket_);
+            socket_ = INVALID_SOCKET;
+        }
+        connected_.store(false, std::memory_order_release);
+        std::cout << "[Replica] Disconnected from primary at sequence " << received_sequence() << "\n";
+
+        if (!reconnect()) break;
+        std::cout << "[Replica] Reconnected to primary, resuming after sequence " << received_sequence() << "\n";
+    }
+}
+
+bool ReplicaReceiver::reconnect() {
+    constexpr auto kPollStop = std::chrono::milliseconds(20);
+    while (running_) {
+        const SOCKET sock = open_endpoint(endpoint_, false);
+        if (sock != INVALID_SOCKET) {
+            std::lock_guard<std::mutex> lock(socket_mutex_);
+            if (!running_) {
+                closesocket(sock);
+                return false;
+            }
+            socket_ = sock;
+            connected_.store(true, std::memory_order_release);
+            return true;
+        }
+
+        const auto retry_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(kReconnectMs);
+        while (running_ && std::chrono::steady_clock::now() < retry_at) {
+            std::this_thread::sleep_for(kPollStop);
+        }
+    }
+    return false;
+}
+
+void ReplicaReceiver::follow() {
+    constexpr std::size_t kRecordsPerRead = 256;
+    std::vector<char> buffer(kRecordsPerRead * sizeof(ReplicationRecord));
+    std::size_t filled = 0;
+
+    // Tell the primary where to resume; a half-restored book needs a whole snapshot
+    std::uint64_t ack = consistent() ? received_sequence_.load(std::memory_order_relaxed) : kResumeFromSnapshot;
+    if (!send_all(socket_, reinterpret_cast<const char*>(&ack), sizeof(ack))) return;
+
+    while (true) {
+        const int bytes = recv(socket_, buffer.data() + filled, static_cast<int>(buffer.size() - filled), 0);
+        if (bytes <= 0) return;
+        filled += static_cast<std::size_t>(bytes);
+
+        const std::size_t whole = filled / sizeof(ReplicationRecord);
+        for (std::size_t i = 0; i < whole; ++i) {
+            ReplicationRecord record;
+            std::memcpy(&record, buffer.data() + i * sizeof(ReplicationRecord), sizeof(record));
+
+            const auto type = static_cast<EngineEventType>(record.type);
+            const std::uint32_t restoring = restoring_.load(std::memory_order_relaxed);
+            const std::uint64_t received = received_sequence_.load(std::memory_order_relaxed);
+            if (type == EngineEventType::SNAPSHOT) {
+                // Replaces everything applied so far
+                restoring_.store(static_cast<std::uint32_t>(record.quantity), std::memory_order_release);
+                std::cout << "[Replica] Restoring snapshot at sequence " << record.sequence
+                          << " (" << record.quantity << " resting orders)\n";
+            } else if (type == EngineEventType::RESTORE_ORDER) {
+                if (restoring == 0 || record.sequence != received) {
+                    std::cerr << "[Replica] Unexpected snapshot order at sequence " << record.sequence
+                              << "; resynchronising\n";
+                    return;
+                }
+                restoring_.store(restoring - 1, std::memory_order_release);
+            } else if (restoring != 0 || record.sequence != received + 1) {
+                // Nothing past a gap is applied; reconnecting asks for a resend from the last good sequence
+                std::cerr << "[Replica] Sequence gap: expected "
+                          << (restoring != 0 ? "a snapshot order" : std::to_string(received + 1))
+                          << ", got " << record.sequence << "; resynchronising\n";
+                return;
+            }
+
+            received_sequence_.store(record.sequence, std::memory_order_relaxed);
+            last_lag_ns_.store(static_cast<std::int64_t>(wall_clock_ns() - record.sent_ns),
+                               std::memory_order_relaxed);
+            if (record.session > highest_session_.load(std::memory_order_relaxed)) {
+                highest_session_.store(record.session, std::memory_order_relaxed);
+            }
+            if (type == EngineEventType::NEW_ORDER || type == EngineEventType::SNAPSHOT) {
+                // A snapshot holds only resting orders, so it carries the primary's counter as well
+                const std::uint64_t number = type == EngineEventType::SNAPSHOT ? record.order_number
+                                                                               : order_id_number(record.order_id);
+                if (number > highest_order_number_.load(std::memory_order_relaxed)) {
+                    highest_order_number_.store(number, std::memory_order_relaxed);
+                }
+            }
+
+            engine_queue_.push(record.to_event());
+        }
+
+        const std::size_t consumed = whole * sizeof(ReplicationRecord);
+        std::memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+        filled -= consumed;
+
+        ack = received_sequence_.load(std::memory_order_relaxed);
+        if (!send_all(socket_, reinterpret_cast<const char*>(&ack), sizeof(ack))) return;
+    }
+}
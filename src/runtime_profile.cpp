@@ -0,0 +1,147 @@
+#include "runtime_profile.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace {
+
+bool parse_switch(const std::string& flag, const std::string& value) {
+    if (value == "on") return true;
+    if (value == "off") return false;
+    throw std::invalid_argument(flag + " expects on or off, got: " + value);
+}
+
+} // namespace
+
+bool RuntimeProfile::parse_option(const std::string& flag, const std::string& value) {
+    if (flag == "--profile") {
+        if (value == "low-latency") mode = RuntimeMode::LOW_LATENCY;
+        else if (value == "power-saving") mode = RuntimeMode::POWER_SAVING;
+        else throw std::invalid_argument("Invalid profile: " + value);
+    } else if (flag == "--cores") {
+        // ENGINE[,GATEWAY[,PUBLISHER[,ANALYTICS]]]
+        std::istringstream ss(value);
+        std::string core;
+        int* targets[] = {&engine_core, &gateway_core, &publisher_core, &analytics_core};
+        const unsigned available = std::thread::hardware_concurrency();  // 0 if unknown
+        for (int* target : targets) {
+            if (!std::getline(ss, core, ',')) break;
+            std::size_t used = 0;
+            const int parsed = std::stoi(core, &used);
+            if (used != core.size() || parsed < -1 ||
+                (parsed >= 0 && available != 0 && static_cast<unsigned>(parsed) >= available)) {
+                throw std::invalid_argument("--cores expects -1 or a core from 0 to " +
+                                            std::to_string(available ? available - 1 : 0) + ", got: " + core);
+            }
+            *target = parsed;
+        }
+    } else if (flag == "--book-mb") {
+        book_memory_mb = static_cast<std::size_t>(std::stoul(value));
+    } else if (flag == "--hugepages") {
+        hugepages = parse_switch(flag, value);
+    } else if (flag == "--mlock") {
+        lock_memory = parse_switch(flag, value);
+    } else if (flag == "--jitter-ms") {
+        jitter_probe = std::chrono::milliseconds(std::stol(value));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string RuntimeProfile::describe() const {
+    auto core = [](int c) { return c < 0 ? std::string("any") : std::to_string(c); };
+
+    std::ostringstream oss;
+    oss << "Runtime profile: " << ::to_string(mode)
+        << " (cores: engine " << core(engine_core) << ", gateway " << core(gateway_core)
+        << ", publisher " << core(publisher_core) << ", analytics " << core(analytics_core) << ")";
+    if (low_latency()) {
+        oss << ", book memory " << book_memory_mb << " MB"
+            << (hugepages ? ", huge pages" : "") << (lock_memory ? ", locked" : "");
+    }
+    return oss.str();
+}
+
+bool pin_current_thread(int core) {
+    if (core < 0) return false;
+#if defined(__linux__)
+    if (core >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    if (core >= static_cast<int>(sizeof(DWORD_PTR) * 8)) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) != 0;
+#else
+    return false;
+#endif
+}
+
+void pin_current_thread_or_warn(int core, const char* thread_name) {
+    if (core >= 0 && !pin_current_thread(core)) {
+        std::cerr << "Could not pin the " << thread_name << " thread to core " << core << ", running unpinned\n";
+    }
+}
+
+std::string JitterReport::to_string() const {
+    std::ostringstream oss;
+    oss << samples << " samples over " << elapsed_ns / 1000000 << " ms"
+        << ", clock read " << min_gap_ns << " ns"
+        << ", max gap " << max_gap_ns / 1000.0 << " us"
+        << ", gaps >1us " << gaps_over_1us
+        << ", >10us " << gaps_over_10us
+        << ", >100us " << gaps_over_100us
+        << ", time lost " << (elapsed_ns ? 100.0 * stolen_ns / elapsed_ns : 0.0) << "%";
+    return oss.str();
+}
+
+JitterReport measure_jitter(int core, std::chrono::milliseconds duration) {
+    JitterReport report;
+
+    // Runs on its own thread so only the probe, not the caller, is pinned
+    std::thread probe([&] {
+        using clock = std::chrono::steady_clock;
+        pin_current_thread_or_warn(core, "jitter probe");
+
+        const auto start = clock::now();
+        const auto end = start + duration;
+        auto previous = start;
+        report.min_gap_ns = UINT64_MAX;
+
+        while (previous < end) {
+            const auto now = clock::now();
+            const auto gap = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - previous).count());
+            previous = now;
+
+            ++report.samples;
+            report.min_gap_ns = std::min(report.min_gap_ns, gap);
+            report.max_gap_ns = std::max(report.max_gap_ns, gap);
+            if (gap > 1000) {
+                ++report.gaps_over_1us;
+                report.stolen_ns += gap;
+                if (gap > 10000) ++report.gaps_over_10us;
+                if (gap > 100000) ++report.gaps_over_100us;
+            }
+        }
+
+        report.elapsed_ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(previous - start).count());
+        if (report.samples == 0) report.min_gap_ns = 0;
+    });
+    probe.join();
+
+    return report;
+}
@@ -0,0 +1,77 @@
+#include "shm_channel.hpp"
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+std::string ShmChannel::name_for(SessionId session_id) {
+#ifdef _WIN32
+    return "/ome_" + std::to_string(session_id);
+#else
+    return "/ome_" + std::to_string(getpid()) + "_" + std::to_string(session_id);
+#endif
+}
+
+#ifdef _WIN32
+
+std::unique_ptr<ShmChannel> ShmChannel::create(const std::string&) { return nullptr; }
+std::unique_ptr<ShmChannel> ShmChannel::open(const std::string&) { return nullptr; }
+ShmChannel::~ShmChannel() = default;
+
+#else
+
+std::unique_ptr<ShmChannel> ShmChannel::create(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "shm_open failed for " << name << "\n";
+        return nullptr;
+    }
+
+    if (ftruncate(fd, sizeof(ShmRegion)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    void* memory = mmap(nullptr, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    auto* region = new (memory) ShmRegion();
+    return std::unique_ptr<ShmChannel>(new ShmChannel(name, region, true));
+}
+
+std::unique_ptr<ShmChannel> ShmChannel::open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        std::cerr << "shm_open failed for " << name << "\n";
+        return nullptr;
+    }
+
+    void* memory = mmap(nullptr, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return nullptr;
+
+    auto* region = static_cast<ShmRegion*>(memory);
+    if (region->magic != ShmRegion::kMagic) {
+        std::cerr << "Unexpected shared-memory layout in " << name << "\n";
+        munmap(memory, sizeof(ShmRegion));
+        return nullptr;
+    }
+    return std::unique_ptr<ShmChannel>(new ShmChannel(name, region, false));
+}
+
+ShmChannel::~ShmChannel() {
+    munmap(region_, sizeof(ShmRegion));
+    if (owner_) shm_unlink(name_.c_str());
+}
+
+#endif
@@ -0,0 +1,229 @@
+#include "trade_analytics.hpp"
+#include "runtime_profile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string_view>
+
+// How long the analytics thread sleeps when there is nothing to process
+constexpr auto kIdleSleep = std::chrono::milliseconds(1);
+
+namespace {
+
+void copy_id(char (&dest)[24], const char* client_id) {
+    std::memset(dest, 0, sizeof(dest));
+    std::strncpy(dest, client_id, sizeof(dest) - 1);
+}
+
+} // namespace
+
+TradeAnalytics::TradeAnalytics(std::chrono::milliseconds bar_interval)
+    : bar_interval_ms_(static_cast<std::uint64_t>(std::max<long long>(1, bar_interval.count()))),
+      bars_(new BarSlot[kBarCount]),
+      clients_(new ClientSlot[kMaxClients]) {
+    claim_client(kOverflowClient);  // Claimed first so it always sits in its home slot
+}
+
+TradeAnalytics::~TradeAnalytics() {
+    stop();
+}
+
+void TradeAnalytics::start() {
+    running_ = true;
+    thread_ = std::thread(&TradeAnalytics::run, this);
+}
+
+void TradeAnalytics::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+void TradeAnalytics::record(const Trade& trade) {
+    TradePrint print;
+    print.time_ms = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(trade.timestamp.time_since_epoch()).count());
+    print.price = trade.price;
+    print.quantity = trade.quantity;
+    copy_id(print.buy_client_id, trade.buy_client_id.c_str());
+    copy_id(print.sell_client_id, trade.sell_client_id.c_str());
+
+    if (!queue_.try_push(print)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TradeAnalytics::run() {
+    pin_current_thread_or_warn(cpu_core_, "analytics");
+    while (true) {
+        auto print = queue_.try_pop();
+        if (print) {
+            apply(*print);
+            continue;
+        }
+        if (!running_) break;  // Queue drained after stop()
+        std::this_thread::sleep_for(kIdleSleep);
+    }
+}
+
+void TradeAnalytics::apply(const TradePrint& print) {
+    const double notional = print.price * print.quantity;
+    const std::uint64_t bucket = print.time_ms / bar_interval_ms_ * bar_interval_ms_;
+
+    // A trade in a later bucket opens a new bar; anything else folds into the current one
+    const Summary& previous = summary_.writer_value();
+    const std::uint64_t bars = previous.totals.bars;
+    const bool new_bar = bars == 0 || bucket > previous.current_bar.start_ms;
+
+    // The closed bar reaches the ring before the count that exposes it to readers
+    if (new_bar && bars > 0) bars_[(bars - 1) % kBarCount].store(previous.current_bar);
+
+    summary_.update([&](Summary& summary) {
+        TradeTotals& totals = summary.totals;
+        ++totals.trades;
+        totals.volume += print.quantity;
+        totals.notional += notional;
+        totals.last_price = print.price;
+
+        OhlcvBar& bar = summary.current_bar;
+        if (new_bar) {
+            ++totals.bars;
+            bar = OhlcvBar{};
+            bar.start_ms = bucket;
+            bar.open = bar.high = bar.low = bar.close = print.price;
+            bar.volume = print.quantity;
+            bar.notional = notional;
+            bar.trades = 1;
+        } else {
+            bar.high = std::max(bar.high, print.price);
+            bar.low = std::min(bar.low, print.price);
+            bar.close = print.price;
+            bar.volume += print.quantity;
+            bar.notional += notional;
+            ++bar.trades;
+        }
+    });
+
+    add_client_volume(print.buy_client_id, print.quantity, 0, notional);
+    add_client_volume(print.sell_client_id, 0, print.quantity, notional);
+}
+
+void TradeAnalytics::add_client_volume(const char* client_id, long long bought, long long sold, double notional) {
+    ClientSlot* slot = client_id[0] != '\0' ? claim_client(client_id) : nullptr;
+    if (!slot) slot = claim_client(kOverflowClient);
+
+    slot->update([&](ClientVolume& client) {
+        client.bought += bought;
+        client.sold += sold;
+        client.notional += notional;
+        ++client.trades;
+    });
+}
+
+TradeAnalytics::ClientSlot* TradeAnalytics::claim_client(const char* client_id) {
+    const std::size_t home = home_slot(client_id);
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+        ClientSlot& slot = clients_[(home + probe) % kMaxClients];
+        const ClientVolume& client = slot.writer_value();
+
+        if (client.client_id[0] == '\0') {
+            if (client_count_ + 1 >= kMaxClients) return nullptr;  // Keep the table from filling up
+            ClientVolume claimed{};
+            copy_id(claimed.client_id, client_id);
+            slot.store(claimed);
+            ++client_count_;
+            return &slot;
+        }
+        if (std::strncmp(client.client_id, client_id, sizeof(client.client_id) - 1) == 0) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+std::size_t TradeAnalytics::home_slot(const char* client_id) {
+    const std::string_view key(client_id, ::strnlen(client_id, 23));
+    return std::hash<std::string_view>{}(key) % kMaxClients;
+}
+
+TradeTotals TradeAnalytics::totals() const {
+    TradeTotals totals = summary_.load().totals;
+    totals.dropped = dropped_.load(std::memory_order_relaxed);
+    return totals;
+}
+
+bool TradeAnalytics::snapshot(TradeTotals& totals, OhlcvBar& current) const {
+    const Summary summary = summary_.load();
+    totals = summary.totals;
+    totals.dropped = dropped_.load(std::memory_order_relaxed);
+    if (summary.totals.bars == 0) return false;
+
+    current = summary.current_bar;
+    return true;
+}
+
+bool TradeAnalytics::bar(std::size_t age, OhlcvBar& out) const {
+    if (age == 0) {
+        TradeTotals totals;
+        return snapshot(totals, out);
+    }
+
+    // A bar closing between reading the count and the slot can recycle that slot: re-check the count and retry
+    std::uint64_t bars = summary_.load().totals.bars;
+    while (true) {
+        if (age >= bars || age >= kBarCount) return false;
+
+        out = bars_[(bars - 1 - age) % kBarCount].load();
+        const std::uint64_t after = summary_.load().totals.bars;
+        if (after == bars) return true;
+        bars = after;
+    }
+}
+
+bool TradeAnalytics::client_volume(const std::string& client_id, ClientVolume& out) const {
+    const std::size_t home = home_slot(client_id.c_str());
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+        out = clients_[(home + probe) % kMaxClients].load();
+        if (out.client_id[0] == '\0') return false;
+        if (std::strncmp(out.client_id, client_id.c_str(), sizeof(out.client_id) - 1) == 0) {
+            return out.trades > 0;
+        }
+    }
+    return false;
+}
+
+void TradeAnalytics::write_report(std::ostream& out) const {
+    const TradeTotals totals = this->totals();
+    out << "Trades,Volume,Notional,VWAP,LastPrice,Dropped\n"
+        << totals.trades << "," << totals.volume << "," << totals.notional << ","
+        << totals.vwap() << "," << totals.last_price << "," << totals.dropped << "\n\n";
+
+    out << "BarStartMs,Open,High,Low,Close,Volume,VWAP,Trades\n";
+    const std::size_t retained = static_cast<std::size_t>(std::min<std::uint64_t>(totals.bars, kBarCount));
+    for (std::size_t age = retained; age-- > 0;) {
+        OhlcvBar bar;
+        if (!this->bar(age, bar)) continue;
+        out << bar.start_ms << "," << bar.open << "," << bar.high << "," << bar.low << ","
+            << bar.close << "," << bar.volume << "," << bar.vwap() << "," << bar.trades << "\n";
+    }
+
+    out << "\nClientID,Bought,Sold,Notional,Trades\n";
+    for (std::size_t i = 0; i < kMaxClients; ++i) {
+        const ClientVolume client = clients_[i].load();
+        if (client.trades == 0) continue;
+        out << client.client_id << "," << client.bought << "," << client.sold << ","
+            << client.notional << "," << client.trades << "\n";
+    }
+}
+
+void TradeAnalytics::write_report_to_file(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open analytics report file: " << filename << "\n";
+        return;
+    }
+
+    write_report(file);
+    std::cout << "Trade analytics saved to " << filename << "\n";
+}